@@ -0,0 +1,64 @@
+// log cost per time step of FakeSimulator::log_file
+// legacy: file opened, localtime formatted and file closed for each line
+// sink: LogSink (opened once, buffered, monotonic time offsets)
+// a time step writes two lines (time step header and number of iterations)
+#include <iostream>
+#include <fstream>
+#include <ctime>
+#include <iomanip>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include "logSink.h"
+
+template <typename T>
+void log_file_legacy(const char* path, T toLog)
+{
+	auto now = std::time(nullptr);
+	std::ofstream stream(path, std::ios::app);
+	stream << std::put_time(std::localtime(&now), "%c") << ": "  << toLog << std::endl;
+}
+
+template <typename Log>
+double nanoseconds_per_timeStep(const int& numberOfTimeSteps, Log log)
+{
+	const auto start = std::chrono::steady_clock::now();
+	for(int i=0; i<numberOfTimeSteps; ++i)
+	{
+		log("Time step: " + std::to_string(i) + "\t1 1000000.000000 100.000000 0.010000");
+		log("\tIterations: " + std::to_string(i % 30));
+	}
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+		numberOfTimeSteps;
+}
+
+int main(int argc, char* argv[])
+{
+	const int numberOfTimeSteps = (argc > 1) ? std::stoi(argv[1]) : 20000;
+	const char* path_legacy = "bench_log_legacy.txt";
+	const char* path_sink = "bench_log_sink.txt";
+
+	const double legacy = nanoseconds_per_timeStep(numberOfTimeSteps,
+		[path_legacy](const std::string& line) { log_file_legacy(path_legacy, line); });
+
+	double sink;
+	{
+		LogSink logSink;
+		const auto start = std::chrono::steady_clock::now();
+		logSink.open(path_sink);
+		nanoseconds_per_timeStep(numberOfTimeSteps,
+			[&logSink](const std::string& line) { logSink.write(line); });
+		logSink.close();  // cost of open and close included
+		sink = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+			numberOfTimeSteps;
+	}
+
+	std::remove(path_legacy);
+	std::remove(path_sink);
+
+	std::cout << "log cost per time step (" << numberOfTimeSteps << " time steps)\n";
+	std::cout << "\tlegacy log_file:\t" << legacy << " ns\n";
+	std::cout << "\tLogSink:\t\t" << sink << " ns\n";
+	std::cout << "\tspeedup:\t\t" << legacy / sink << "\n";
+	return 0;
+}
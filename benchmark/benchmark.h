@@ -0,0 +1,104 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <ostream>
+
+// minimal benchmark harness: warm-up, repetitions, percentiles, json output
+namespace bench
+{
+
+struct result_t
+{
+	std::string group, name;
+	int repetitions;
+	long operations;  // per repetition
+	double min, p10, median, p90, p99, max, mean;  // nanoseconds per operation
+};
+
+template<typename T>
+inline void do_not_optimize(const T& value)
+{
+	asm volatile("" : : "g"(&value) : "memory");
+}
+
+inline double percentile(const std::vector<double>& sorted, const double& p)
+{	// linear interpolation between closest ranks
+	if(sorted.empty())
+		return 0.;
+	const double rank = p * (sorted.size() - 1);
+	const std::size_t lower = static_cast<std::size_t>(rank);
+	const std::size_t upper = std::min(lower + 1, sorted.size() - 1);
+	return sorted[lower] + (rank - lower) * (sorted[upper] - sorted[lower]);
+}
+
+// function(operations) executes operations - timed once per repetition
+template<typename Function>
+result_t run(const std::string& group, const std::string& name,
+	const int& warmup, const int& repetitions, const long& operations, Function function)
+{
+	for(int i=0; i<warmup; ++i)
+		function(operations);
+
+	std::vector<double> times(repetitions);
+	for(int i=0; i<repetitions; ++i)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		function(operations);
+		times[i] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+			operations;
+	}
+	std::sort(times.begin(), times.end());
+
+	result_t result;
+	result.group = group;
+	result.name = name;
+	result.repetitions = repetitions;
+	result.operations = operations;
+	result.min = times.front();
+	result.p10 = percentile(times, .1);
+	result.median = percentile(times, .5);
+	result.p90 = percentile(times, .9);
+	result.p99 = percentile(times, .99);
+	result.max = times.back();
+	double sum = 0.;
+	for(const double& time : times)
+		sum += time;
+	result.mean = sum / repetitions;
+	return result;
+}
+
+inline void write_table(std::ostream& stream, const std::vector<result_t>& results)
+{
+	stream << "group\tname\tmedian [ns]\tp10\tp90\tp99\n";
+	for(const result_t& result : results)
+		stream << result.group << "\t" << result.name << "\t" << result.median << "\t" <<
+			result.p10 << "\t" << result.p90 << "\t" << result.p99 << "\n";
+}
+
+// meta: pairs of key and (already quoted if string) value
+inline void write_json(std::ostream& stream, const std::vector<result_t>& results,
+	const std::vector<std::pair<std::string, std::string> >& meta)
+{
+	stream << "{\n";
+	for(const std::pair<std::string, std::string>& entry : meta)
+		stream << "  \"" << entry.first << "\": " << entry.second << ",\n";
+	stream << "  \"unit\": \"ns/op\",\n  \"benchmarks\": [\n";
+	for(std::size_t i=0; i<results.size(); ++i)
+	{
+		const result_t& result = results[i];
+		stream << "    { \"group\": \"" << result.group << "\", \"name\": \"" << result.name <<
+			"\", \"repetitions\": " << result.repetitions << ", \"operations\": " << result.operations <<
+			", \"min\": " << result.min << ", \"p10\": " << result.p10 << ", \"median\": " << result.median <<
+			", \"p90\": " << result.p90 << ", \"p99\": " << result.p99 << ", \"max\": " << result.max <<
+			", \"mean\": " << result.mean << " }" << ((i + 1 < results.size()) ? "," : "") << "\n";
+	}
+	stream << "  ]\n}\n";
+}
+
+} // end namespace bench
+
+#endif
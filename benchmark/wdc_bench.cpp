@@ -0,0 +1,275 @@
+// benchmarks of WellDoubletControl
+// micro: single calls (evaluate_simulation_result, configure, heat pump COP, threshold factor)
+// macro: FakeSimulator::simulate for the cases of the WellDoubletTest (and on a large grid, with implicit solver),
+// 	FieldSimulator::simulate with 64 doublets on a 512 x 512 grid (serial, on all threads, with controller pipeline)
+// usage: wdc_bench [--micro] [--macro] [--filter substring] [--repetitions n] [--json path]
+// times are in nanoseconds per operation (median and percentiles over repetitions)
+// micro benchmarks run with event logging (WDC_EVENT) off, macro benchmarks with the LOGGING of the build
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include "benchmark.h"
+#include "wellDoubletControl.h"
+#include "wellDoubletControlBatch.h"
+#include "heatPump.h"
+#include "comparison.h"
+#include "fakeSimulator.h"
+#include "fieldSimulator.h"
+#include "logger.h"
+#include "wdc_config.h"
+
+namespace
+{
+
+struct case_t { int scheme; double Q_H, value_target, value_threshold; };
+
+// as in gtest/test_wellDoubletControl.cpp
+const case_t cases[] = {
+	{ 0, 1.e6, 0.01, 100. }, { 0, 1.e6, 0.01, 80. }, { 0, -1.e5, -0.01, 30. }, { 0, -1.e6, -0.01, 30. },
+	{ 1, 1.e5, 100., 0.01 }, { 1, 1.e6, 100., 0.01 }, { 1, 2.e6, 100., 0.01 },
+	{ 1, -1.e5, 25., -0.01 }, { 1, -5.e5, 25., -0.01 }, { 1, -1.e6, 25., -0.01 },
+	{ 2, 1.e6, 450.e6, 0.01 }, { 2, 2.e6, 450.e6, 0.01 }, { 2, -5.e5, -125.e6, -0.01 }, { 2, -1.e6, -125.e6, -0.01 }
+};
+
+// storing parameters per scheme
+const double value_target[] = { 0.01, 100., 450.e6 };
+const double value_threshold[] = { 80., 0.01, 0.01 };
+
+const wdc::WellDoubletControl::balancing_properties_t properties[] = {
+	{ 50., 10., 5.e6, 5.e6 }, { 120., 10., 5.e6, 5.e6 }, { 90., 12., 5.e6, 5.e6 } };
+
+struct null_buffer_t : std::streambuf
+{
+	int overflow(int c) override { return c; }
+};
+
+struct options_t
+{
+	bool micro, macro;
+	std::string filter, json;
+	int repetitions;
+};
+
+bool selected(const options_t& options, const std::string& name)
+{
+	return options.filter.empty() || name.find(options.filter) != std::string::npos;
+}
+
+void run_micro(const options_t& options, std::vector<bench::result_t>& results)
+{
+	const int warmup = 3, repetitions = options.repetitions;
+	const long operations = 10000;
+	const wdc::WellDoubletControl::accuracies_t accuracies = { 0.01, 10., 1.e-6 };
+
+	for(int scheme=0; scheme<3; ++scheme)
+	{
+		wdc::WellDoubletControl* wellDoubletControl =
+			wdc::WellDoubletControl::create_wellDoubletControl(scheme, 10., accuracies);
+
+		const std::string evaluate = "evaluate_simulation_result_scheme_" + std::to_string(scheme);
+		if(selected(options, evaluate))
+			results.push_back(bench::run("micro", evaluate, warmup, repetitions, operations,
+				[&](const long& n)
+				{
+					wellDoubletControl->reset();
+					wellDoubletControl->configure(1.e6, value_target[scheme], value_threshold[scheme], properties[0]);
+					for(long i=0; i<n; ++i)
+					{
+						wellDoubletControl->evaluate_simulation_result(properties[i % 3]);
+						bench::do_not_optimize(wellDoubletControl->converged());
+					}
+				}));
+
+		const std::string configure = "configure_scheme_" + std::to_string(scheme);
+		if(selected(options, configure))
+			results.push_back(bench::run("micro", configure, warmup, repetitions, operations,
+				[&](const long& n)
+				{
+					for(long i=0; i<n; ++i)
+					{
+						wellDoubletControl->reset();
+						wellDoubletControl->configure(1.e6, value_target[scheme], value_threshold[scheme],
+							properties[i % 3]);
+						bench::do_not_optimize(wellDoubletControl->get_result());
+					}
+				}));
+		delete wellDoubletControl;
+	}
+
+	if(selected(options, "batch_evaluate_scheme_1"))
+	{	// per doublet
+		const std::size_t size = 1024;
+		wdc::WellDoubletControlBatch batch(1, size, 10., accuracies);
+		std::vector<double> Q_H(size, 1.e6), target(size, value_target[1]), threshold(size, value_threshold[1]);
+		std::vector<double> T_HE(size), T_UA(size, 10.), capacity(size, 5.e6);
+		for(std::size_t i=0; i<size; ++i)
+			T_HE[i] = properties[i % 3].T_HE;
+		const wdc::WellDoubletControlBatch::balancing_properties_t batch_properties =
+			{ T_HE.data(), T_UA.data(), capacity.data(), capacity.data() };
+		batch.configure(Q_H.data(), target.data(), threshold.data(), batch_properties);
+		results.push_back(bench::run("micro", "batch_evaluate_scheme_1", warmup, repetitions, size,
+			[&](const long& n)
+			{
+				batch.evaluate_simulation_result(batch_properties);
+				bench::do_not_optimize(batch.get_flowrates()[0]);
+			}));
+	}
+
+	if(selected(options, "heatPump_COP"))
+	{
+		wdc::CarnotHeatPump heatPump(70., 0.5);
+		results.push_back(bench::run("micro", "heatPump_COP", warmup, repetitions, operations,
+			[&](const long& n)
+			{
+				for(long i=0; i<n; ++i)
+					bench::do_not_optimize(heatPump.calculate_heat_source(-1.e6, 20. + (i & 15), 10.));
+			}));
+	}
+
+	if(selected(options, "threshold_factor"))
+		results.push_back(bench::run("micro", "threshold_factor", warmup, repetitions, operations,
+			[&](const long& n)
+			{
+				for(long i=0; i<n; ++i)
+					bench::do_not_optimize(wdc::make_threshold_factor(50. + (i & 15), 60., 10., wdc::upper));
+			}));
+}
+
+void run_macro(const options_t& options, std::vector<bench::result_t>& results)
+{
+	const int warmup = 2, repetitions = options.repetitions;
+
+	// WDC_LOG output (LOGGING 1) is discarded, but formatted
+	null_buffer_t null_buffer;
+	std::streambuf* cout_buffer = std::cout.rdbuf(&null_buffer);
+	for(const case_t& c : cases)
+	{
+		std::stringstream name;
+		name << "simulate_scheme_" << c.scheme << "_" << c.Q_H << "_" << c.value_target << "_" << c.value_threshold;
+		if(!selected(options, name.str()))
+			continue;
+		FakeSimulator simulator;
+		simulator.set_logFile("");
+		results.push_back(bench::run("macro", name.str(), warmup, repetitions, 1,
+			[&](const long&)
+			{
+				simulator.simulate(c.scheme, c.Q_H, c.value_target, c.value_threshold);
+			}));
+	}
+
+	// fake simulator as load generator - grid dominates
+	const std::size_t gridSize = 100000;
+	const std::string name = "simulate_scheme_1_grid_" + std::to_string(gridSize);
+	if(selected(options, name))
+	{
+		FakeSimulator simulator;
+		simulator.set_logFile("");
+		simulator.set_gridSize(gridSize);
+		results.push_back(bench::run("macro", name, 1, std::max(1, repetitions / 10), 1,
+			[&](const long&)
+			{
+				simulator.simulate(1, 1.e6, 100., 0.01);
+			}));
+	}
+
+	// implicit solver with hourly time steps over a day
+	if(selected(options, "simulate_scheme_1_implicit_hourly"))
+	{
+		FakeSimulator simulator;
+		simulator.set_logFile("");
+		simulator.set_gridSize(1000);
+		simulator.set_solver(FakeSimulator::implicit_upwind);
+		simulator.set_diffusivity(1.e-6);
+		simulator.set_timeStepSize(3600.);
+		simulator.set_numberOfTimeSteps(24);
+		results.push_back(bench::run("macro", "simulate_scheme_1_implicit_hourly", warmup, repetitions, 1,
+			[&](const long&)
+			{
+				simulator.simulate(1, 1.e6, 100., 0.01);
+			}));
+	}
+
+	// field of 8 x 8 doublets, storing and extracting alternately
+	const char* field_names[] = { "field_64_doublets_serial", "field_64_doublets_threads", "field_64_doublets_pipeline" };
+	for(int variant=0; variant<3; ++variant)
+	{
+		const std::string field_name = field_names[variant];
+		if(!selected(options, field_name))
+			continue;
+		FieldSimulator field;
+		field.set_grid(512, 512);
+		field.set_numberOfThreads(variant == 0 ? 1 : 0);
+		if(variant == 2)
+			field.set_numberOfControllerThreads(2);
+		for(std::size_t k=0; k<64; ++k)
+		{
+			const std::size_t x = 24 + 60 * (k % 8), y = 24 + 60 * (k / 8);
+			if(k % 2)
+				field.add_doublet(x, y, x + 20, y + 20, 1, -5.e5, 25., -0.01);
+			else
+				field.add_doublet(x, y, x + 20, y + 20, 1, 1.e6, 100., 0.01);
+		}
+		results.push_back(bench::run("macro", field_name, 1, std::max(1, repetitions / 10), 1,
+			[&](const long&)
+			{
+				field.simulate();
+			}));
+	}
+	std::cout.rdbuf(cout_buffer);
+}
+
+}  // end anonymous namespace
+
+
+int main(int argc, char* argv[])
+{
+	options_t options = { false, false, "", "", 30 };
+	for(int i=1; i<argc; ++i)
+	{
+		if(!std::strcmp(argv[i], "--micro"))
+			options.micro = true;
+		else if(!std::strcmp(argv[i], "--macro"))
+			options.macro = true;
+		else if(!std::strcmp(argv[i], "--filter") && i+1 < argc)
+			options.filter = argv[++i];
+		else if(!std::strcmp(argv[i], "--repetitions") && i+1 < argc)
+			options.repetitions = std::max(1, std::atoi(argv[++i]));
+		else if(!std::strcmp(argv[i], "--json") && i+1 < argc)
+			options.json = argv[++i];
+		else
+		{
+			std::cerr << "usage: " << argv[0] <<
+				" [--micro] [--macro] [--filter substring] [--repetitions n] [--json path]\n";
+			return 1;
+		}
+	}
+	if(!options.micro && !options.macro)
+		options.micro = options.macro = true;
+
+	std::vector<bench::result_t> results;
+	if(options.micro)
+	{	// without event recording (default level of production builds)
+		const wdc::log::level_t level = wdc::log::get_level();
+		wdc::log::set_level(wdc::log::off);
+		run_micro(options, results);
+		wdc::log::set_level(level);
+	}
+	if(options.macro)
+		run_macro(options, results);
+
+	bench::write_table(std::cerr, results);
+	if(!options.json.empty())
+	{
+		std::ofstream stream(options.json);
+		bench::write_json(stream, results, {
+			{ "version", "\"" + std::to_string(WellDoubletControl_VERSION_MAJOR) + "." +
+					std::to_string(WellDoubletControl_VERSION_MINOR) + "\"" },
+			{ "build_type", "\"" WDC_BUILD_TYPE "\"" },
+			{ "logging", std::to_string(LOGGING) } });
+	}
+	return 0;
+}
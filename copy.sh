@@ -8,3 +8,5 @@ mkdir -p $wdc_folder
 cp build/src/libwellDoubletControl.a $wdc_folder
 cp src/*.h $wdc_folder
 cp build/wdc_config.h $wdc_folder
+cp build/wdc_capi.h $wdc_folder
+cp -P build/src/libwdc.so* $wdc_folder  # C interface (wdc_capi.h)
@@ -0,0 +1,129 @@
+#include <cmath>
+#include <algorithm>
+#include "advection.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+	#define WDC_SIMD_X86 1
+	#include <immintrin.h>
+	#define WDC_TARGET_AVX2 __attribute__((target("avx2")))
+	#define WDC_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+	#define WDC_SIMD_X86 0
+#endif
+
+namespace
+{
+
+double advect_scalar(const double* previous, const double* reference, double* temperatures,
+	const double& courant, const std::size_t& begin, const std::size_t& end)
+{
+	double error = 0.;
+	for(std::size_t i=begin; i<end; ++i)
+	{
+		temperatures[i] = previous[i] + courant * (previous[i-1] - previous[i]);
+		error = std::max(error, std::fabs(temperatures[i] - reference[i]));
+	}
+	return error;
+}
+
+#if WDC_SIMD_X86
+
+WDC_TARGET_AVX2 double advect_avx2(const double* previous, const double* reference, double* temperatures,
+	const double& courant, const std::size_t& begin, const std::size_t& end)
+{
+	const __m256d c = _mm256_set1_pd(courant);
+	const __m256d sign = _mm256_set1_pd(-0.);
+	__m256d error = _mm256_setzero_pd();
+	std::size_t i = begin;
+	for(; i+4<=end; i+=4)
+	{
+		const __m256d P = _mm256_loadu_pd(previous + i);
+		const __m256d T = _mm256_add_pd(P, _mm256_mul_pd(c, _mm256_sub_pd(_mm256_loadu_pd(previous + i - 1), P)));
+		_mm256_storeu_pd(temperatures + i, T);
+		error = _mm256_max_pd(error, _mm256_andnot_pd(sign, _mm256_sub_pd(T, _mm256_loadu_pd(reference + i))));
+	}
+	double lanes[4];
+	_mm256_storeu_pd(lanes, error);
+	return std::max(std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3])),
+		advect_scalar(previous, reference, temperatures, courant, i, end));
+}
+
+WDC_TARGET_AVX512 double advect_avx512(const double* previous, const double* reference, double* temperatures,
+	const double& courant, const std::size_t& begin, const std::size_t& end)
+{
+	const __m512d c = _mm512_set1_pd(courant);
+	const __m512i magnitude = _mm512_set1_epi64(0x7fffffffffffffffLL);
+	__m512d error = _mm512_setzero_pd();  // mask_max - plain max trips -Wmaybe-uninitialized of gcc 12
+	std::size_t i = begin;
+	for(; i+8<=end; i+=8)
+	{
+		const __m512d P = _mm512_loadu_pd(previous + i);
+		const __m512d T = _mm512_add_pd(P, _mm512_mul_pd(c, _mm512_sub_pd(_mm512_loadu_pd(previous + i - 1), P)));
+		_mm512_storeu_pd(temperatures + i, T);
+		error = _mm512_mask_max_pd(error, 0xff, error, _mm512_castsi512_pd(_mm512_and_epi64(magnitude,
+			_mm512_castpd_si512(_mm512_sub_pd(T, _mm512_loadu_pd(reference + i))))));
+	}
+	double lanes[8];
+	_mm512_storeu_pd(lanes, error);
+	return std::max(*std::max_element(lanes, lanes + 8),
+		advect_scalar(previous, reference, temperatures, courant, i, end));
+}
+
+#endif
+
+}  // end anonymous namespace
+
+
+double advect(const double* previous, const double* reference, double* temperatures,
+	const double& courant, const std::size_t& begin, const std::size_t& end, const wdc::simd::isa_t& isa)
+{
+	if(begin >= end)
+		return 0.;
+#if WDC_SIMD_X86
+	if(isa == wdc::simd::avx512 && wdc::simd::is_supported(wdc::simd::avx512))
+		return advect_avx512(previous, reference, temperatures, courant, begin, end);
+	if(isa == wdc::simd::avx2 && wdc::simd::is_supported(wdc::simd::avx2))
+		return advect_avx2(previous, reference, temperatures, courant, begin, end);
+#endif
+	return advect_scalar(previous, reference, temperatures, courant, begin, end);
+}
+
+double advect_implicit(const double* previous, const double* reference, double* temperatures, double* scratch,
+	const double& courant, const double& diffusion, const std::size_t& source_node, const double& source,
+	const std::size_t& n)
+{
+	temperatures[0] = previous[0];
+	double error = std::fabs(temperatures[0] - reference[0]);
+	const double lower = -(courant + diffusion), upper = -diffusion;
+
+	if(diffusion == 0.)
+	{	// (1 + courant) T[i] = previous[i] + source[i] + courant T[i-1]
+		for(std::size_t i=1; i<n; ++i)
+		{
+			temperatures[i] = (previous[i] + ((i == source_node) ? source : 0.) -
+						lower * temperatures[i-1]) / (1. + courant);
+			error = std::max(error, std::fabs(temperatures[i] - reference[i]));
+		}
+		return error;
+	}
+
+	// forward sweep - scratch holds modified upper diagonal, temperatures modified right hand side
+	double rhs_previous = temperatures[0], upper_previous = 0.;  // row 0 is T[0] = previous[0]
+	for(std::size_t i=1; i<n; ++i)
+	{
+		const double diagonal = (i+1 < n) ? 1. + courant + 2.*diffusion : 1. + courant + diffusion;
+		const double m = diagonal - lower * upper_previous;
+		scratch[i] = (i+1 < n) ? upper / m : 0.;
+		temperatures[i] = (previous[i] + ((i == source_node) ? source : 0.) - lower * rhs_previous) / m;
+		rhs_previous = temperatures[i];
+		upper_previous = scratch[i];
+	}
+	// back substitution
+	error = std::max(error, std::fabs(temperatures[n-1] - reference[n-1]));
+	for(std::size_t i=n-2; i>0; --i)
+	{
+		temperatures[i] -= scratch[i] * temperatures[i+1];
+		error = std::max(error, std::fabs(temperatures[i] - reference[i]));
+	}
+	return error;
+}
@@ -0,0 +1,26 @@
+#ifndef ADVECTION_H
+#define ADVECTION_H
+
+#include <cstddef>
+#include "kernels.h"  // for the instruction sets
+
+// fused kernel of the fake simulator - one sweep over [begin, end) computes
+// 	temperatures[i] = previous[i] + courant * (previous[i-1] - previous[i])  (explicit upwind)
+// and returns max |temperatures[i] - reference[i]| (error to previous iteration)
+// results are identical for all instruction sets (no fma, max is exact)
+// previous[begin-1] must exist - temperatures must not alias previous or reference
+double advect(const double* previous, const double* reference, double* temperatures,
+	const double& courant, const std::size_t& begin, const std::size_t& end,
+	const wdc::simd::isa_t& isa = wdc::simd::best_isa());
+
+// implicit upwind (backward euler) with optional diffusion on the whole grid [0, n)
+// 	-(courant + diffusion) T[i-1] + (1 + courant + 2 diffusion) T[i] - diffusion T[i+1] = previous[i] + source[i]
+// (diffusion = timeStepSize * diffusivity / dx^2) is stable for any time step size
+// inlet T[0] = previous[0], zero gradient at outlet, source only at source_node
+// tridiagonal system is solved with the thomas algorithm - bidiagonal (forward substitution) without diffusion
+// scratch needs n elements, returns max |temperatures[i] - reference[i]| as advect
+double advect_implicit(const double* previous, const double* reference, double* temperatures, double* scratch,
+	const double& courant, const double& diffusion, const std::size_t& source_node, const double& source,
+	const std::size_t& n);
+
+#endif
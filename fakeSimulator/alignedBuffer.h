@@ -0,0 +1,51 @@
+#ifndef ALIGNEDBUFFER_H
+#define ALIGNEDBUFFER_H
+
+#include <cstdlib>
+#include <cstdint>
+#include <cstddef>
+#include <new>
+
+
+// contiguous, uninitialized storage aligned to cache lines (and SIMD registers)
+// reallocates only if the size changes
+template <typename T>
+class AlignedBuffer
+{
+	static const std::size_t c_alignment = 64;
+
+	void* allocation;  // as returned by malloc
+	T* buffer;  // aligned into allocation
+	std::size_t numberOfElements;
+
+	void release() { std::free(allocation); allocation = nullptr; buffer = nullptr; numberOfElements = 0; }
+public:
+	AlignedBuffer() : allocation(nullptr), buffer(nullptr), numberOfElements(0) {}
+	explicit AlignedBuffer(const std::size_t& size) : AlignedBuffer() { resize(size); }
+	~AlignedBuffer() { release(); }
+	AlignedBuffer(const AlignedBuffer&) = delete;
+	AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+
+	void resize(const std::size_t& size)
+	{
+		if(size == numberOfElements)
+			return;
+		release();
+		if(size == 0)
+			return;
+		allocation = std::malloc(size * sizeof(T) + c_alignment);
+		if(allocation == nullptr)
+			throw std::bad_alloc();
+		buffer = reinterpret_cast<T*>((reinterpret_cast<std::uintptr_t>(allocation) + c_alignment - 1) &
+						~(c_alignment - 1));
+		numberOfElements = size;
+	}
+
+	std::size_t size() const { return numberOfElements; }
+	T* data() { return buffer; }
+	const T* data() const { return buffer; }
+	T& operator[](const std::size_t& i) { return buffer[i]; }
+	const T& operator[](const std::size_t& i) const { return buffer[i]; }
+};
+
+#endif
@@ -0,0 +1,169 @@
+#include "couplingPipeline.h"
+#include <chrono>
+#include <algorithm>
+
+namespace
+{
+
+const long c_spinDuration = 100000;  // ns - controller threads sleep afterwards
+
+long nanoseconds_now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+long nanoseconds_since(const std::chrono::steady_clock::time_point& start)
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+}  // end anonymous namespace
+
+
+CouplingPipeline::CouplingPipeline(const std::size_t& numberOfThreads, const std::size_t& queueCapacity) :
+	numberOfPendingItems(0), stopping(false), iteration_start(0), pushing(false)
+{
+	reset_statistics();
+	const std::size_t n = (numberOfThreads > 0) ? numberOfThreads :
+				std::max(1u, std::thread::hardware_concurrency());
+	for(std::size_t i=0; i<n; ++i)
+		workers.emplace_back(new worker_t(queueCapacity));
+	for(std::unique_ptr<worker_t>& worker : workers)
+	{
+		worker_t* _worker = worker.get();
+		worker->thread = std::thread([this, _worker]() { run(*_worker); });
+	}
+}
+
+CouplingPipeline::~CouplingPipeline()
+{
+	wait();
+	stopping.store(true, std::memory_order_release);
+	for(std::unique_ptr<worker_t>& worker : workers)
+	{
+		{
+			std::lock_guard<std::mutex> lock(worker->mutex);
+		}  // sleeping thread waits or sees stopping
+		worker->wake.notify_one();
+		worker->thread.join();
+	}
+}
+
+void CouplingPipeline::run(worker_t& worker)
+{
+	item_t item;
+	bool idle = false;
+	long idle_start = 0;
+	while(true)
+	{
+		if(worker.queue.pop(item))
+		{
+			if(idle)
+			{	// waiting before the simulator started this iteration is not counted
+				worker.idle.fetch_add(nanoseconds_now() -
+					std::max(idle_start, iteration_start.load(std::memory_order_relaxed)),
+					std::memory_order_relaxed);
+				idle = false;
+			}
+			item.driver->evaluate(item.balancing_properties);
+			numberOfPendingItems.fetch_sub(1, std::memory_order_release);  // result is published
+			continue;
+		}
+		if(stopping.load(std::memory_order_acquire))
+			break;
+		if(!idle)
+		{
+			idle = true;
+			idle_start = nanoseconds_now();
+		}
+		if(nanoseconds_now() - idle_start < c_spinDuration)
+			std::this_thread::yield();
+		else
+			sleep(worker);
+	}
+}
+
+void CouplingPipeline::sleep(worker_t& worker)
+{
+	std::unique_lock<std::mutex> lock(worker.mutex);
+	worker.sleeping.store(true, std::memory_order_relaxed);
+	// pairs with fence in notify - either push sees sleeping or this thread sees the item
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	while(worker.queue.empty() && !stopping.load(std::memory_order_acquire))
+		worker.wake.wait(lock);
+	worker.sleeping.store(false, std::memory_order_relaxed);
+}
+
+void CouplingPipeline::notify(worker_t& worker)
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if(!worker.sleeping.load(std::memory_order_relaxed))
+		return;
+	{
+		std::lock_guard<std::mutex> lock(worker.mutex);
+	}  // thread waits or has not checked the queue yet
+	worker.wake.notify_one();
+}
+
+void CouplingPipeline::push(const std::size_t& doublet, const item_t& item)
+{
+	worker_t& worker = *workers[doublet % workers.size()];
+	const std::size_t occupancy = worker.queue.size();
+	occupancy_sum += occupancy;
+	occupancy_max = std::max(occupancy_max, occupancy);
+	++numberOfItems;
+	if(!pushing)
+	{
+		pushing = true;
+		iteration_start.store(nanoseconds_now(), std::memory_order_relaxed);  // published by queue
+	}
+
+	numberOfPendingItems.fetch_add(1, std::memory_order_relaxed);
+	if(!worker.queue.push(item))
+	{
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		while(!worker.queue.push(item))
+			std::this_thread::yield();
+		producer_stall += nanoseconds_since(start);
+	}
+	notify(worker);
+}
+
+void CouplingPipeline::wait()
+{
+	pushing = false;
+	if(numberOfPendingItems.load(std::memory_order_acquire) == 0)
+		return;
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	while(numberOfPendingItems.load(std::memory_order_acquire) != 0)
+		std::this_thread::yield();
+	drain_wait += nanoseconds_since(start);
+}
+
+std::size_t CouplingPipeline::get_numberOfSleepingThreads() const
+{
+	std::size_t n = 0;
+	for(const std::unique_ptr<worker_t>& worker : workers)
+		n += worker->sleeping.load(std::memory_order_relaxed);
+	return n;
+}
+
+CouplingPipeline::statistics_t CouplingPipeline::get_statistics() const
+{
+	long consumer_idle = 0;
+	for(const std::unique_ptr<worker_t>& worker : workers)
+		consumer_idle += worker->idle.load(std::memory_order_relaxed);
+	return { numberOfItems, (numberOfItems > 0) ? occupancy_sum / numberOfItems : 0., occupancy_max,
+		1.e-9 * producer_stall, 1.e-9 * consumer_idle, 1.e-9 * drain_wait };
+}
+
+void CouplingPipeline::reset_statistics()
+{
+	numberOfItems = 0;
+	occupancy_sum = 0.;
+	occupancy_max = 0;
+	producer_stall = drain_wait = 0;
+	for(std::unique_ptr<worker_t>& worker : workers)
+		worker->idle.store(0, std::memory_order_relaxed);
+}
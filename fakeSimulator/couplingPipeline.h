@@ -0,0 +1,103 @@
+#ifndef COUPLINGPIPELINE_H
+#define COUPLINGPIPELINE_H
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include "couplingDriver.h"
+#include "ringBuffer.h"
+
+
+// pipelined coupling of many controllers with a simulator (FieldSimulator::set_numberOfControllerThreads)
+// the simulator thread publishes the balancing properties of each doublet into a lock-free queue
+// (wdc::RingBuffer - one per controller thread, single producer / single consumer) and continues
+// with the next doublet while controller threads evaluate, wait() returns when all results are written
+// doublet i is always evaluated by thread i % numberOfThreads - evaluations of a controller keep their order
+// controller threads spin (yield) for c_spinDuration while their queue is empty, then sleep until push wakes them
+// (grid solves and time between simulations do not occupy cores)
+class CouplingPipeline
+{
+public:
+	struct item_t
+	{
+		wdc::CouplingDriver* driver;  // of the doublet - evaluate is called by the controller thread
+		wdc::WellDoubletControl::balancing_properties_t balancing_properties;
+	};
+
+	struct statistics_t
+	{
+		long numberOfItems;  // pushed
+		double occupancy_mean;  // queue size seen by push
+		std::size_t occupancy_max;
+		double producer_stall;  // s - simulator waits for space in a full queue
+		double consumer_idle;  // s - controller threads wait for items of the current iteration (sum over threads)
+		double drain_wait;  // s - simulator waits for the results in wait()
+	};
+private:
+	struct worker_t
+	{
+		wdc::RingBuffer<item_t> queue;
+		std::thread thread;
+		std::atomic<long> idle;  // ns
+		std::mutex mutex;  // for sleeping only
+		std::condition_variable wake;
+		std::atomic<bool> sleeping;
+		explicit worker_t(const std::size_t& capacity) : queue(capacity), idle(0), sleeping(false) {}
+
+		// queue keeps head and tail on own cache lines - new is not aligned before C++17
+		static void* operator new(std::size_t size)
+		{
+			void* allocation = std::malloc(size + 64 + sizeof(void*));
+			if(allocation == nullptr)
+				throw std::bad_alloc();
+			void** aligned = reinterpret_cast<void**>((reinterpret_cast<std::uintptr_t>(allocation) +
+							sizeof(void*) + 63) & ~std::uintptr_t(63));
+			aligned[-1] = allocation;
+			return aligned;
+		}
+		static void operator delete(void* pointer)
+		{
+			if(pointer != nullptr)
+				std::free(static_cast<void**>(pointer)[-1]);
+		}
+	};
+
+	std::vector<std::unique_ptr<worker_t>> workers;
+	std::atomic<long> numberOfPendingItems;  // pushed but not evaluated
+	std::atomic<bool> stopping;
+	std::atomic<long> iteration_start;  // ns - first push after wait
+	char padding[64];  // counters below are written by the simulator thread only
+
+	bool pushing;  // between first push and wait
+	long numberOfItems;
+	double occupancy_sum;
+	std::size_t occupancy_max;
+	long producer_stall, drain_wait;  // ns
+
+	void run(worker_t& worker);
+	void sleep(worker_t& worker);  // until queue is not empty or stopping
+	void notify(worker_t& worker);  // after push
+public:
+	explicit CouplingPipeline(const std::size_t& numberOfThreads, const std::size_t& queueCapacity = 64);
+			// numberOfThreads 0: hardware concurrency
+	~CouplingPipeline();
+	CouplingPipeline(const CouplingPipeline&) = delete;
+	CouplingPipeline& operator=(const CouplingPipeline&) = delete;
+
+	std::size_t size() const { return workers.size(); }
+	std::size_t get_numberOfSleepingThreads() const;
+	void push(const std::size_t& doublet, const item_t& item);  // blocks (spins) while queue is full
+	void wait();  // until all pushed items are evaluated - results can be read afterwards
+
+	statistics_t get_statistics() const;  // call between wait() and the next push
+	void reset_statistics();
+};
+
+#endif
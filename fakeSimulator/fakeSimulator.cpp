@@ -1,85 +1,151 @@
 #include "fakeSimulator.h"
 #include <string>
-#include <fstream>
-#include <ctime>
-#include <iomanip>
+#include <algorithm>
+#include "advection.h"
 #include "wdc_config.h"
 
 
 
 void FakeSimulator::create_wellDoubletControl(const int& selection)
 {
+	if(wellDoubletControl != nullptr && wellDoubletControl->get_scheme_ID() == selection)
+	{	// from last timestep - re-armed instead of reallocated
+		apply_settings();
+		if(!warmStart)
+			wellDoubletControl->reset();  // else rates of last time step are used as start values
+		return;
+	}
 	if(wellDoubletControl != nullptr)
-		delete wellDoubletControl;  // from last timestep
+		delete wellDoubletControl;  // scheme changed
 	wellDoubletControl = 
 		wdc::WellDoubletControl::create_wellDoubletControl(selection, 10., // well_shutdown_temperature_range 
 			{c_accuracy_temperature, c_accuracy_powerrate, c_accuracy_flowrate});
+	apply_settings();
 }
 
+void FakeSimulator::apply_settings()
+{
+	wellDoubletControl->set_traceRecorder(traceRecorder.is_open() ? &traceRecorder : nullptr);
+	wellDoubletControl->set_heatPumpTable(heatPumpTable);
+	wellDoubletControl->set_heatPump(heatPump_type, heatPump_T_sink, heatPump_eta);
+	wellDoubletControl->set_warm_start(warmStart);
+	wellDoubletControl->set_flowrate_adaption(flowrate_adaption);
+	wellDoubletControl->set_powerrate_adaption(powerrate_adaption);
+	wellDoubletControl->set_statistics_enabled(statistics_enabled);
+}
+
+
+bool FakeSimulator::set_traceFile(const std::string& path)
+{
+	traceRecorder.close();
+	return path.empty() || traceRecorder.open(path);
+}
 
 void FakeSimulator::initialize_temperatures()
 {
 	WDC_LOG("\tinitialize simulation");
-	for(int i=0; i<c_gridSize; i++)
-	{
-		temperatures_previousTimestep[i] = c_temperature_storage_initial; 
-		temperatures_previousIteration[i] = c_temperature_storage_initial; 
-		temperatures[i] = c_temperature_storage_initial; 
+	for(AlignedBuffer<double>& grid : grids)
+		grid.resize(gridSize);  // allocates if grid size changed
+	if(solver == implicit_upwind)
+		scratch.resize(gridSize);
+	double* initial = grids[0].data();
+	for(std::size_t i=0; i<gridSize; i++)
+		initial[i] = c_temperature_storage_initial; 
 					// as input for WellDoubletControl
-	}
+	temperatures = initial;
+	temperatures_previousIteration = initial;
+	temperatures_previousTimestep = initial;
 	WDC_LOG(*this);
 }
 
+double* FakeSimulator::unused_grid()
+{
+	for(AlignedBuffer<double>& grid : grids)
+		if(grid.data() != temperatures_previousIteration && grid.data() != temperatures_previousTimestep)
+			return grid.data();
+	return nullptr;  // not reached - three grids for two previous fields
+}
+
+void FakeSimulator::set_numberOfThreads(const std::size_t& _numberOfThreads)
+{
+	pool.reset(nullptr);
+	if(_numberOfThreads != 1)
+		pool.reset(new ThreadPool(_numberOfThreads));
+	numberOfThreads = pool ? pool->size() : 1;
+	errors.resize(numberOfThreads);
+}
+
+double FakeSimulator::advect(const double& courant, const std::size_t& begin, const std::size_t& end)
+{
+	if(numberOfThreads == 1 || end < begin + numberOfThreads * c_minimumNumberOfNodesPerThread)
+		return ::advect(temperatures_previousTimestep, temperatures_previousIteration, temperatures,
+				courant, begin, end);
+
+	const std::size_t part = (end - begin + numberOfThreads - 1) / numberOfThreads;
+	pool->parallel_for(numberOfThreads, [&](const std::size_t& i)
+	{
+		errors[i] = ::advect(temperatures_previousTimestep, temperatures_previousIteration, temperatures,
+				courant, begin + i * part, std::min(begin + (i+1) * part, end));
+	});
+	return *std::max_element(errors.begin(), errors.end());
+}
+
 void FakeSimulator::calculate_temperatures(const double& Q_H, 
 						const double& Q_W)
-{
+{	// error to previous iteration is computed in the same sweep
 	WDC_LOG("\t\tcalculate ");
-	// update inlet node
-	temperatures[0] = temperatures_previousTimestep[0];
-
-	for(int i=1; i<c_gridSize; i++)
-	{  // grid spacing is one meter (just 1 D - not radial)
-		// calculate temperatures on [1, GRIDSIZE)
-		// use always fabs(Q_W) > 0 (for injection and inextraction)
-		// (temperature at well 2 is fixed)
-		temperatures[i] = temperatures_previousTimestep[i] +
-			c_timeStepSize * fabs(Q_W) * c_porosity *
-			(temperatures_previousTimestep[i-1] - temperatures_previousTimestep[i]);
+	if(temperatures == temperatures_previousIteration || temperatures == temperatures_previousTimestep)
+		temperatures = unused_grid();  // instead of copying the previous fields away
+	const double* previous = temperatures_previousTimestep;
+	const double* reference = temperatures_previousIteration;
+	// grid spacing is one meter (just 1 D - not radial)
+	// use always fabs(Q_W) > 0 (for injection and inextraction)
+	// (temperature at well 2 is fixed)
+	const double courant = timeStepSize * fabs(Q_W) * c_porosity;
+	const std::size_t n = c_heatExchanger_nodeNumber;
+
+	if(solver == implicit_upwind)
+	{	// sequential (recurrence)
+		error = advect_implicit(previous, reference, temperatures, scratch.data(),
+			courant, timeStepSize * diffusivity, n, timeStepSize * Q_H / c_heatCapacity, gridSize);
+		return;
 	}
 
-	// add source term
-	temperatures[c_heatExchanger_nodeNumber] += c_timeStepSize * Q_H / c_heatCapacity;
+	// update inlet node
+	temperatures[0] = previous[0];
+	error = std::fabs(temperatures[0] - reference[0]);
+
+	error = std::max(error, advect(courant, 1, n));
+	// heat exchanger node with source term
+	temperatures[n] = previous[n] + courant * (previous[n-1] - previous[n]);
+	temperatures[n] += timeStepSize * Q_H / c_heatCapacity;
+	error = std::max(error, std::fabs(temperatures[n] - reference[n]));
+	error = std::max(error, advect(courant, n+1, gridSize));
 }
 
 void FakeSimulator::update_temperatures()
-{
-	for(int i=0; i<c_gridSize; i++)
-	{
-		temperatures_previousTimestep[i] = temperatures[i];
-		temperatures_previousIteration[i] = temperatures[i];
-	}
+{	// next calculate_temperatures writes into another grid
+	temperatures_previousTimestep = temperatures;
+	temperatures_previousIteration = temperatures;
 }
 
 void FakeSimulator::execute_timeStep(const double& well2_temperature)
-{
-	int i;
-	for(i=0; i<c_maxNumberOfIterations; i++)
+{	// driver was started in simulate
+	while(!driver.finished())
 	{
-		WDC_LOG("\titeration " << i);
-		calculate_temperatures(wellDoubletControl->get_result().Q_H,
-					wellDoubletControl->get_result().Q_W);
-		wellDoubletControl->evaluate_simulation_result(
-			{ temperatures[c_heatExchanger_nodeNumber], well2_temperature,
-				c_heatCapacity, c_heatCapacity });
-		if(i >= c_minNumberOfIterations-2 &&
-			(calculate_error() < c_accuracy_temperature && 
-			wellDoubletControl->converged()))
+		if(driver.get_state() == wdc::CouplingDriver::solve)
 		{
-			//std::cout << "break\n";
-			break;
+			WDC_LOG("\titeration " << driver.get_iteration());
+			const wdc::CouplingDriver::request_t request = driver.get_request();
+			calculate_temperatures(request.Q_H, request.Q_W);
+			driver.evaluate({ temperatures[c_heatExchanger_nodeNumber], well2_temperature,
+				c_heatCapacity, c_heatCapacity });
 		}
+		else
+			driver.check(calculate_error());
 	}
-	log_file("\tIterations: " + std::to_string(i));
+	numberOfIterations += driver.get_numberOfIterations();
+	log_file("\tIterations: " + std::to_string(driver.get_iteration()));
 }
 
 void FakeSimulator::simulate(const int& wellDoubletControlScheme,
@@ -90,14 +156,14 @@ void FakeSimulator::simulate(const int& wellDoubletControlScheme,
 			c_temperature_upwindAquifer_storing : c_temperature_upwindAquifer_extracting;
  
 	initialize_temperatures();
+	if(!logFile_path.empty())
+		logSink.open(logFile_path);
+	numberOfIterations = 0;
+	if(wellDoubletControl != nullptr)
+		wellDoubletControl->reset();  // no warm start from a previous simulation
 
-	std::fstream fout("timer.txt", std::ofstream::out | std::ios::app);
-	Timer<std::fstream> timer(std::string(
-			std::to_string(wellDoubletControlScheme) + " " +
-			std::to_string(Q_H) + " " +
-			std::to_string(value_target) + " " +
-			std::to_string(value_threshold)).c_str(), fout);
-	for(int i=0; i<c_numberOfTimeSteps; i++)
+	const auto start = _clock::now();
+	for(int i=0; i<numberOfTimeSteps; i++)
 	{       
 		WDC_LOG("time step " << i);
 		log_file("Time step: " + std::to_string(i) + "\t" +
@@ -106,29 +172,25 @@ void FakeSimulator::simulate(const int& wellDoubletControlScheme,
 			std::to_string(value_target) + " " +
 			std::to_string(value_threshold));
 		create_wellDoubletControl(wellDoubletControlScheme);
-		wellDoubletControl->configure(
+		driver.start(wellDoubletControl,
 			Q_H, value_target, value_threshold,
 			{ temperatures[c_heatExchanger_nodeNumber], well2_temperature,
-			c_heatCapacity, c_heatCapacity }); 
+			c_heatCapacity, c_heatCapacity });
 
 		execute_timeStep(well2_temperature);
 		
 		WDC_LOG(*this);
 		update_temperatures();
 	}
+	duration = std::chrono::duration_cast<precision>(_clock::now() - start).count();
+	logSink.close();
 }
 
 double FakeSimulator::calculate_error()
 {	// error is temperatures
 	// error is powerrate and flowrate given by WDC
-	double error = 0.;
-
-	for(int i=0; i < c_gridSize; i++)
-	{
-		error = std::max(error,
-			std::fabs(temperatures[i] - temperatures_previousIteration[i]));
-		temperatures_previousIteration[i] = temperatures[i];
-	}
+	// (computed in calculate_temperatures)
+	temperatures_previousIteration = temperatures;
 
 	WDC_LOG("\t\terror: " << error);
 	return error;
@@ -137,17 +199,15 @@ double FakeSimulator::calculate_error()
 template <typename T>
 void FakeSimulator::log_file(T toLog)
 {
-	auto now = std::time(nullptr);
-	//stream.imbue(std::locale)
-	std::ofstream stream("logging.txt", std::ios::app);
-	stream << std::put_time(std::localtime(&now), "%c") << ": "  << toLog << std::endl;
-
+	logSink.write(toLog);
 }
 
 std::ostream& operator<<(std::ostream& stream, const FakeSimulator& simulator)
 {
 	stream << "\t\tATES temperature: ";
-        for(int i=0; i<c_gridSize; ++i)
+        for(std::size_t i=0; i<std::min(simulator.gridSize, std::size_t(c_gridSize)); ++i)
                 stream << simulator.temperatures[i] << " ";
+	if(simulator.gridSize > std::size_t(c_gridSize))
+		stream << "... ";  // load generator grids are not printed
         return stream;
 }
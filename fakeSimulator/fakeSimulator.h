@@ -2,9 +2,17 @@
 #define FAKESIMULATOR_H
 
 #include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
 #include "wellDoubletControl.h"
 #include "parameter.h"
 #include "timer.h"
+#include "logSink.h"
+#include "alignedBuffer.h"
+#include "threadPool.h"
+#include "trace.h"
+#include "couplingDriver.h"
 
 
 
@@ -31,25 +39,97 @@ struct Simulator
 
 class FakeSimulator : public Simulator
 {
-        double temperatures[c_gridSize]; 
-        double temperatures_previousIteration[c_gridSize];  // to calculate error 
-        double temperatures_previousTimestep[c_gridSize];
+public:
+	enum solver_t { explicit_upwind, implicit_upwind };
+private:
+	solver_t solver;
+	double diffusivity;  // m^2/s - implicit_upwind only
+	double timeStepSize;
+	int numberOfTimeSteps;
+	std::size_t gridSize;
+	AlignedBuffer<double> grids[3];  // storage of the temperature fields below
+	AlignedBuffer<double> scratch;  // of implicit_upwind
+        double* temperatures; 
+        const double* temperatures_previousIteration;  // to calculate error 
+        const double* temperatures_previousTimestep;
+				// point into grids - fields are handed over by pointer
+				// (previous fields can share a grid, temperatures never does)
+	double error;  // to previous iteration - computed with temperatures
+	std::size_t numberOfThreads;  // to split large grids
+	std::unique_ptr<ThreadPool> pool;  // if more than one thread
+	std::vector<double> errors;  // of the parts of the grid
 
         wdc::WellDoubletControl* wellDoubletControl;
+	wdc::CouplingDriver driver;  // coupling iterations of a time step
         bool flag_iterate;  // to convert threshold value into a target value
-
+	bool warmStart;  // controller continues from rates of previous time step
+	wdc::WellDoubletControl::flowrate_adaption_t flowrate_adaption;
+	wdc::WellDoubletControl::powerrate_adaption_t powerrate_adaption;
+	bool statistics_enabled;  // of wellDoubletControl
+	int heatPump_type;  // 0: no heat pump, 1: Carnot, 2: tabulated
+	double heatPump_T_sink, heatPump_eta;
+	std::shared_ptr<const wdc::COPTable> heatPumpTable;  // for type 2
+	int numberOfIterations;  // sum over all time steps of last simulation
+	double duration;  // of last simulation in microseconds (wdc_bench for benchmarks)
+	std::string logFile_path;
+	LogSink logSink;  // open during simulate
+	wdc::TraceRecorder traceRecorder;  // open from set_traceFile until destruction
+
+	void apply_settings();  // to wellDoubletControl
+	double* unused_grid();  // by the previous fields
+	double advect(const double& courant, const std::size_t& begin, const std::size_t& end);
+				// on [begin, end) - split across threads for large grids, returns error
 public:
-	FakeSimulator() : wellDoubletControl(nullptr) {}
+	FakeSimulator() : solver(explicit_upwind), diffusivity(0.),
+		timeStepSize(c_timeStepSize), numberOfTimeSteps(c_numberOfTimeSteps),
+		gridSize(c_gridSize), temperatures(nullptr),
+		temperatures_previousIteration(nullptr), temperatures_previousTimestep(nullptr),
+		error(0.), numberOfThreads(1),
+		wellDoubletControl(nullptr),
+		driver(c_minNumberOfIterations, c_maxNumberOfIterations, c_accuracy_temperature), warmStart(false),
+		flowrate_adaption(wdc::WellDoubletControl::fixed_point),
+		powerrate_adaption(wdc::WellDoubletControl::fixed_gain), statistics_enabled(false),
+		heatPump_type(0), heatPump_T_sink(0.), heatPump_eta(0.),
+		numberOfIterations(0), duration(0.), logFile_path("logging.txt") {}
 	~FakeSimulator() 
 	{ if(wellDoubletControl != nullptr) delete wellDoubletControl; }
-			// a wellDoubletControl instance is constructed 
-			// (and destructed) each time step
+			// a wellDoubletControl instance is constructed once
+			// and reset each time step
 
 	const bool& get_flag_iterate() const override { return flag_iterate; }
+	void set_warmStart(const bool& _warmStart) { warmStart = _warmStart; }
+	void set_adaptiveTolerance(const bool& adaptive)  // of controller while error is large (CouplingDriver)
+	{ driver.set_tolerance(adaptive ? wdc::CouplingDriver::adaptive_tolerance : wdc::CouplingDriver::fixed_tolerance); }
+	void set_flowrate_adaption(const wdc::WellDoubletControl::flowrate_adaption_t& _flowrate_adaption)
+	{ flowrate_adaption = _flowrate_adaption; }
+	void set_powerrate_adaption(const wdc::WellDoubletControl::powerrate_adaption_t& _powerrate_adaption)
+	{ powerrate_adaption = _powerrate_adaption; }
+	void set_statistics_enabled(const bool& _statistics_enabled) { statistics_enabled = _statistics_enabled; }
+	void set_heatPump(const int& type, const double& T_sink, const double& eta)
+	{ heatPump_type = type; heatPump_T_sink = T_sink; heatPump_eta = eta; }
+	void set_heatPumpTable(const std::shared_ptr<const wdc::COPTable>& table) { heatPumpTable = table; }
+	void set_solver(const solver_t& _solver) { solver = _solver; }
+				// explicit_upwind needs timeStepSize * |Q_W| * porosity <= 1
+	void set_diffusivity(const double& _diffusivity) { diffusivity = _diffusivity; }
+	void set_timeStepSize(const double& _timeStepSize) { timeStepSize = _timeStepSize; }
+	void set_numberOfTimeSteps(const int& _numberOfTimeSteps) { numberOfTimeSteps = _numberOfTimeSteps; }
+	void set_gridSize(const std::size_t& _gridSize)
+	{ gridSize = std::max(_gridSize, std::size_t(c_heatExchanger_nodeNumber + 1)); }
+					// heat exchanger node is kept - grid is allocated in simulate
+	std::size_t get_gridSize() const { return gridSize; }
+	void set_numberOfThreads(const std::size_t& _numberOfThreads);  // 0: hardware concurrency
+	const double* get_temperatures() const { return temperatures; }
+	void set_logFile(const std::string& _logFile_path) { logFile_path = _logFile_path; }
+					// empty: no log file
+	bool set_traceFile(const std::string& path);  // records all coupling iterations (wdc_replay)
+					// empty: stops recording
+	int get_numberOfIterations() const { return numberOfIterations; }
+	double get_duration() const { return duration; }
 	const wdc::WellDoubletControl* get_wellDoubletControl() const override
 	{ return wellDoubletControl; }
 	void create_wellDoubletControl(const int& selection) override;
 				// is done at the begiining of each time step
+				// (allocates only if scheme changes)
 
         void initialize_temperatures() override;
 	void calculate_temperatures(const double& Q_H, const double& Q_W);
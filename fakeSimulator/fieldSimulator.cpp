@@ -0,0 +1,222 @@
+#include "fieldSimulator.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include "timer.h"
+#include "wdc_config.h"
+
+namespace
+{
+
+// explicit diffusion on rows [row_begin, row_end) with sources, boundary columns are kept
+// reference can be temperatures (each cell is read before it is written), returns max change to reference
+double diffuse(const double* previous, const double* reference, double* temperatures, const double* sources,
+	const double& r, const std::size_t& nx, const std::size_t& row_begin, const std::size_t& row_end)
+{
+	double error = 0.;
+	for(std::size_t y=row_begin; y<row_end; ++y)
+	{
+		const std::size_t row = y * nx;
+		error = std::max(error, std::fabs(previous[row] - reference[row]));
+		temperatures[row] = previous[row];
+		for(std::size_t c=row+1; c<row+nx-1; ++c)
+		{
+			const double T = previous[c] + r * (previous[c-1] + previous[c+1] + previous[c-nx] + previous[c+nx] -
+						4. * previous[c]) + sources[c];
+			error = std::max(error, std::fabs(T - reference[c]));
+			temperatures[c] = T;
+		}
+		const std::size_t last = row + nx - 1;
+		error = std::max(error, std::fabs(previous[last] - reference[last]));
+		temperatures[last] = previous[last];
+	}
+	return error;
+}
+
+double copy_row(const double* previous, const double* reference, double* temperatures, const std::size_t& begin,
+	const std::size_t& end)
+{
+	double error = 0.;
+	for(std::size_t c=begin; c<end; ++c)
+	{
+		error = std::max(error, std::fabs(previous[c] - reference[c]));
+		temperatures[c] = previous[c];
+	}
+	return error;
+}
+
+}  // end anonymous namespace
+
+
+void FieldSimulator::set_grid(const std::size_t& _nx, const std::size_t& _ny)
+{
+	nx = std::max(_nx, std::size_t(3));  // one interior cell
+	ny = std::max(_ny, std::size_t(3));
+	doublets.clear();
+}
+
+void FieldSimulator::set_numberOfThreads(const std::size_t& _numberOfThreads)
+{
+	pool.reset(nullptr);
+	if(_numberOfThreads != 1)
+		pool.reset(new ThreadPool(_numberOfThreads));
+	numberOfThreads = pool ? pool->size() : 1;
+	errors.resize(numberOfThreads);
+}
+
+void FieldSimulator::set_numberOfControllerThreads(const std::size_t& numberOfControllerThreads)
+{
+	pipeline.reset(nullptr);
+	if(numberOfControllerThreads > 0)
+		pipeline.reset(new CouplingPipeline(numberOfControllerThreads));
+}
+
+CouplingPipeline::statistics_t FieldSimulator::get_pipelineStatistics() const
+{
+	if(pipeline)
+		return pipeline->get_statistics();
+	return { 0, 0., 0, 0., 0., 0. };
+}
+
+bool FieldSimulator::add_doublet(const std::size_t& x_warm, const std::size_t& y_warm,
+	const std::size_t& x_cold, const std::size_t& y_cold,
+	const int& scheme, const double& Q_H, const double& value_target, const double& value_threshold)
+{
+	const bool inside = x_warm > 0 && x_warm < nx-1 && y_warm > 0 && y_warm < ny-1 &&
+			x_cold > 0 && x_cold < nx-1 && y_cold > 0 && y_cold < ny-1;
+	if(!inside || (x_warm == x_cold && y_warm == y_cold))
+		return false;
+	doublets.push_back(doublet_t());
+	doublet_t& doublet = doublets.back();
+	doublet.warmWell = y_warm * nx + x_warm;
+	doublet.coldWell = y_cold * nx + x_cold;
+	doublet.scheme = scheme;
+	doublet.Q_H = Q_H;
+	doublet.value_target = value_target;
+	doublet.value_threshold = value_threshold;
+	return true;
+}
+
+void FieldSimulator::initialize_temperatures()
+{
+	for(AlignedBuffer<double>& grid : grids)
+	{
+		grid.resize(nx * ny);  // allocates if grid size changed
+		std::fill(grid.data(), grid.data() + nx * ny, c_temperature_storage_initial);
+	}
+	sources.resize(nx * ny);
+	std::fill(sources.data(), sources.data() + nx * ny, 0.);
+	temperatures_previousTimestep = grids[0].data();
+	temperatures = grids[1].data();
+}
+
+void FieldSimulator::set_sources()
+{	// reset first - injection wells of several doublets can share a cell
+	for(const doublet_t& doublet : doublets)
+		sources[(doublet.Q_H > 0.) ? doublet.warmWell : doublet.coldWell] = 0.;
+	for(const doublet_t& doublet : doublets)
+	{
+		const std::size_t injection = (doublet.Q_H > 0.) ? doublet.warmWell : doublet.coldWell;
+		const std::size_t production = (doublet.Q_H > 0.) ? doublet.coldWell : doublet.warmWell;
+		const wdc::WellDoubletControl::result_t& result = doublet.wellDoubletControl->get_result();
+		const double courant = timeStepSize * std::fabs(result.Q_W) * c_porosity;
+		sources[injection] += courant * (temperatures_previousTimestep[production] -
+						temperatures_previousTimestep[injection]) +
+					timeStepSize * result.Q_H / c_heatCapacity;
+	}
+}
+
+double FieldSimulator::calculate_temperatures(const double* reference)
+{
+	const double* previous = temperatures_previousTimestep;
+	const double r = timeStepSize * diffusivity;  // grid spacing is one meter
+	double error = std::max(copy_row(previous, reference, temperatures, 0, nx),
+				copy_row(previous, reference, temperatures, (ny-1) * nx, ny * nx));
+	const std::size_t rows = ny - 2;  // interior
+	if(numberOfThreads == 1 || rows * nx < numberOfThreads * c_minimumNumberOfNodesPerThread)
+		return std::max(error, diffuse(previous, reference, temperatures, sources.data(), r, nx, 1, ny-1));
+
+	// domain decomposition - strips of rows read previous only, no halo exchange
+	const std::size_t part = (rows + numberOfThreads - 1) / numberOfThreads;
+	pool->parallel_for(numberOfThreads, [&](const std::size_t& i)
+	{
+		const std::size_t begin = std::min(1 + i * part, ny-1), end = std::min(1 + (i+1) * part, ny-1);
+		errors[i] = diffuse(previous, reference, temperatures, sources.data(), r, nx, begin, end);
+	});
+	return std::max(error, *std::max_element(errors.begin(), errors.end()));
+}
+
+void FieldSimulator::configure(const std::size_t& i)
+{
+	doublet_t& doublet = doublets[i];
+	if(!doublet.wellDoubletControl || doublet.wellDoubletControl->get_scheme_ID() != doublet.scheme)
+		doublet.wellDoubletControl.reset(wdc::WellDoubletControl::create_wellDoubletControl(doublet.scheme, 10.,
+			{c_accuracy_temperature, c_accuracy_powerrate, c_accuracy_flowrate}));
+	else
+		doublet.wellDoubletControl->reset();
+	const std::size_t injection = (doublet.Q_H > 0.) ? doublet.warmWell : doublet.coldWell;
+	const std::size_t production = (doublet.Q_H > 0.) ? doublet.coldWell : doublet.warmWell;
+	doublet.driver.start(doublet.wellDoubletControl.get(), doublet.Q_H, doublet.value_target, doublet.value_threshold,
+		{ temperatures_previousTimestep[injection], temperatures_previousTimestep[production],
+			c_heatCapacity, c_heatCapacity });
+}
+
+void FieldSimulator::evaluate(const std::size_t& i)
+{
+	doublet_t& doublet = doublets[i];
+	const std::size_t injection = (doublet.Q_H > 0.) ? doublet.warmWell : doublet.coldWell;
+	const std::size_t production = (doublet.Q_H > 0.) ? doublet.coldWell : doublet.warmWell;
+	const wdc::WellDoubletControl::balancing_properties_t balancing_properties =
+		{ temperatures[injection], temperatures[production], c_heatCapacity, c_heatCapacity };
+	if(pipeline)  // next doublet is gathered while this one is evaluated
+		pipeline->push(i, { &doublet.driver, balancing_properties });
+	else
+		doublet.driver.evaluate(balancing_properties);
+}
+
+void FieldSimulator::execute_timeStep()
+{	// drivers of all doublets advance in lockstep - the field error is shared
+	for(int i=0; ; i++)
+	{
+		set_sources();
+		// first iteration is compared with previous time step, then updated in place
+		const double error = calculate_temperatures((i == 0) ? temperatures_previousTimestep : temperatures);
+		for(std::size_t j=0; j<doublets.size(); ++j)
+			evaluate(j);
+		if(pipeline)
+			pipeline->wait();
+		bool converged = true, not_converged = false;
+		for(doublet_t& doublet : doublets)
+		{
+			const wdc::CouplingDriver::state_t state = doublet.driver.check(error);
+			converged = converged && state == wdc::CouplingDriver::converged;
+			not_converged = not_converged || state == wdc::CouplingDriver::not_converged;
+		}
+		if(converged || not_converged)
+		{
+			numberOfIterations += i+1;
+			return;
+		}
+		for(doublet_t& doublet : doublets)
+			doublet.driver.resume();  // field still changes
+	}
+}
+
+void FieldSimulator::simulate()
+{
+	initialize_temperatures();
+	numberOfIterations = 0;
+	if(pipeline)
+		pipeline->reset_statistics();
+	const auto start = _clock::now();
+	for(int i=0; i<numberOfTimeSteps; i++)
+	{
+		WDC_LOG("field time step " << i);
+		for(std::size_t j=0; j<doublets.size(); ++j)
+			configure(j);
+		execute_timeStep();
+		std::swap(temperatures_previousTimestep, temperatures);  // next iterate is written into the older grid
+	}
+	std::swap(temperatures_previousTimestep, temperatures);  // last field is returned by get_temperatures
+	duration = std::chrono::duration_cast<precision>(_clock::now() - start).count();
+}
@@ -0,0 +1,93 @@
+#ifndef FIELDSIMULATOR_H
+#define FIELDSIMULATOR_H
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include "wellDoubletControl.h"
+#include "couplingDriver.h"
+#include "parameter.h"
+#include "alignedBuffer.h"
+#include "threadPool.h"
+#include "couplingPipeline.h"
+
+
+// many well doublets in one aquifer - a 2D grid (nx * ny cells of one meter, boundary kept at initial temperature)
+// each doublet has a warm and a cold well (cells) and its own WellDoubletControl
+// storing: water from the cold well is heated and injected into the warm well, extracting: vice versa
+// 	injection cell: T += courant * (T_production - T) + timeStepSize * Q_H / c_heatCapacity
+// 	heat spreads by diffusion - plumes of neighbouring doublets interfere
+// balancing properties of a controller are T_HE (injection well) and T_UA (production well)
+// all doublets are coupled in the same iteration loop - one CouplingDriver per doublet is checked with the
+// error of the field, converged drivers are resumed until all drivers converged
+// the explicit grid update is split into strips of rows across threads (results do not depend on threads)
+// controllers can be evaluated on their own threads, pipelined with gathering (CouplingPipeline)
+class FieldSimulator
+{
+public:
+	struct doublet_t
+	{
+		std::size_t warmWell, coldWell;  // cell index y * nx + x
+		int scheme;
+		double Q_H, value_target, value_threshold;  // as for WellDoubletControl::configure
+		std::unique_ptr<wdc::WellDoubletControl> wellDoubletControl;  // created in simulate
+		wdc::CouplingDriver driver;  // coupling iterations of a time step
+
+		doublet_t() : warmWell(0), coldWell(0), scheme(0), Q_H(0.), value_target(0.), value_threshold(0.),
+			driver(c_minNumberOfIterations, c_maxNumberOfIterations, c_accuracy_temperature) {}
+	};
+private:
+	std::size_t nx, ny;
+	double diffusivity;  // m^2/s - explicit: timeStepSize * diffusivity <= 0.25
+	double timeStepSize;
+	int numberOfTimeSteps;
+	std::vector<doublet_t> doublets;
+	AlignedBuffer<double> grids[2];
+	AlignedBuffer<double> sources;  // per cell and iteration - non-zero at injection wells
+	double* temperatures;  // iterate (updated in place)
+	double* temperatures_previousTimestep;
+	std::size_t numberOfThreads;
+	std::unique_ptr<ThreadPool> pool;  // if more than one thread
+	std::vector<double> errors;  // of the strips
+	std::unique_ptr<CouplingPipeline> pipeline;  // if controllers have own threads
+	int numberOfIterations;  // sum over all time steps of last simulation
+	double duration;  // of last simulation in microseconds
+
+	void initialize_temperatures();
+	void set_sources();  // from results of controllers
+	double calculate_temperatures(const double* reference);  // returns error to reference
+	void configure(const std::size_t& i);
+	void evaluate(const std::size_t& i);
+	void execute_timeStep();
+public:
+	FieldSimulator() : nx(64), ny(64), diffusivity(1.e-3), timeStepSize(c_timeStepSize),
+		numberOfTimeSteps(c_numberOfTimeSteps), temperatures(nullptr), temperatures_previousTimestep(nullptr),
+		numberOfThreads(1), errors(1), numberOfIterations(0), duration(0.) {}
+
+	void set_grid(const std::size_t& _nx, const std::size_t& _ny);  // removes doublets
+	std::size_t get_nx() const { return nx; }
+	std::size_t get_ny() const { return ny; }
+	void set_diffusivity(const double& _diffusivity) { diffusivity = _diffusivity; }
+	void set_timeStepSize(const double& _timeStepSize) { timeStepSize = _timeStepSize; }
+	void set_numberOfTimeSteps(const int& _numberOfTimeSteps) { numberOfTimeSteps = _numberOfTimeSteps; }
+	void set_numberOfThreads(const std::size_t& _numberOfThreads);  // 0: hardware concurrency
+	void set_numberOfControllerThreads(const std::size_t& numberOfControllerThreads);
+			// 0: controllers are evaluated on the simulator thread (default)
+	CouplingPipeline::statistics_t get_pipelineStatistics() const;  // of last simulation (zero without pipeline)
+
+	bool add_doublet(const std::size_t& x_warm, const std::size_t& y_warm,
+		const std::size_t& x_cold, const std::size_t& y_cold,
+		const int& scheme, const double& Q_H, const double& value_target, const double& value_threshold);
+			// false if a well is not inside the boundary or both wells are in the same cell
+	std::size_t get_numberOfDoublets() const { return doublets.size(); }
+	const wdc::WellDoubletControl* get_wellDoubletControl(const std::size_t& i) const
+	{ return doublets[i].wellDoubletControl.get(); }
+
+	void simulate();
+	int get_numberOfIterations() const { return numberOfIterations; }
+	double get_duration() const { return duration; }
+	const double* get_temperatures() const { return temperatures; }  // nx * ny, row-major
+	double get_temperature(const std::size_t& x, const std::size_t& y) const { return temperatures[y * nx + x]; }
+};
+
+#endif
@@ -0,0 +1,30 @@
+#include "logSink.h"
+#include <ctime>
+#include <iomanip>
+
+
+void LogSink::open(const std::string& path)
+{
+	close();
+	buffer.reset(new char[c_bufferSize]);
+	stream.rdbuf()->pubsetbuf(buffer.get(), c_bufferSize);  // before open
+	stream.open(path, std::ios::app);
+
+	const std::time_t now = std::time(nullptr);
+	start = std::chrono::steady_clock::now();
+	stream << std::put_time(std::localtime(&now), "%c") << ": log opened\n";
+}
+
+void LogSink::close()
+{
+	if(stream.is_open())
+		stream.close();
+	stream.rdbuf()->pubsetbuf(nullptr, 0);  // before buffer is released
+	buffer.reset();
+}
+
+void LogSink::write_prefix()
+{
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	stream << '+' << std::fixed << std::setprecision(6) << seconds << std::defaultfloat << "s: ";
+}
@@ -0,0 +1,41 @@
+#ifndef LOGSINK_H
+#define LOGSINK_H
+
+#include <string>
+#include <fstream>
+#include <chrono>
+#include <memory>
+
+
+// persistent, buffered log file
+// opened once (per simulation), lines are prefixed with seconds since opening
+// (monotonic clock) - wall-clock time is written once in the header line
+class LogSink
+{
+	static const std::size_t c_bufferSize = 1 << 16;
+
+	std::ofstream stream;
+	std::unique_ptr<char[]> buffer;  // of stream - allocated in open (simulators without log file stay small)
+	std::chrono::steady_clock::time_point start;
+
+	void write_prefix();
+public:
+	LogSink() {}
+	~LogSink() { close(); }
+	LogSink(const LogSink&) = delete;
+	LogSink& operator=(const LogSink&) = delete;
+
+	void open(const std::string& path);  // appends
+	void close();  // writes and releases buffer
+	bool is_open() const { return stream.is_open(); }
+
+	template <typename T> void write(const T& toLog)
+	{
+		if(!stream.is_open())
+			return;
+		write_prefix();
+		stream << toLog << '\n';  // no std::endl - buffer is written when full or at close
+	}
+};
+
+#endif
@@ -11,7 +11,7 @@ const double c_heatCapacity = 5.e6;
 const double c_porosity = 0.5;
 
 // mesh and geometry
-const int c_gridSize = 11;
+const int c_gridSize = 11;  // default of FakeSimulator::set_gridSize
 const int c_heatExchanger_nodeNumber = 5;
 
 // numerics
@@ -22,5 +22,6 @@ const double c_timeStepSize = 1.e2;
 const double c_accuracy_temperature = 0.01;
 const double c_accuracy_flowrate = 1.e-6;
 const double c_accuracy_powerrate = 10;
+const int c_minimumNumberOfNodesPerThread = 1 << 15;  // smaller grids are not split
 
 #endif
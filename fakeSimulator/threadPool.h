@@ -0,0 +1,146 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <cstddef>
+
+
+// work-stealing thread pool
+// each worker has its own task queue: it takes tasks from the back of its queue
+// and steals from the front of the other queues if its queue is empty
+class ThreadPool
+{
+	typedef std::function<void()> task_t;
+
+	struct queue_t
+	{
+		std::mutex mutex;
+		std::deque<task_t> tasks;
+	};
+
+	std::vector<queue_t> queues;
+	std::vector<std::thread> workers;
+	std::atomic<std::size_t> next_queue;  // round robin for submit
+	std::atomic<long> numberOfOpenTasks;  // submitted but not finished
+	std::atomic<long> numberOfQueuedTasks;  // submitted but not started
+	std::atomic<long> numberOfStolenTasks;
+	std::mutex mutex;  // for condition variables
+	std::condition_variable work_available, work_done;
+	bool stopping;
+
+	bool pop(const std::size_t& index, task_t& task)
+	{
+		std::lock_guard<std::mutex> lock(queues[index].mutex);
+		if(queues[index].tasks.empty())
+			return false;
+		task = std::move(queues[index].tasks.back());
+		queues[index].tasks.pop_back();
+		--numberOfQueuedTasks;
+		return true;
+	}
+
+	bool steal(const std::size_t& index, task_t& task)
+	{
+		for(std::size_t i=1; i<queues.size(); ++i)
+		{
+			queue_t& queue = queues[(index + i) % queues.size()];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if(!queue.tasks.empty())
+			{
+				task = std::move(queue.tasks.front());
+				queue.tasks.pop_front();
+				--numberOfQueuedTasks;
+				++numberOfStolenTasks;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void work(const std::size_t& index)
+	{
+		task_t task;
+		while(true)
+		{
+			if(pop(index, task) || steal(index, task))
+			{
+				task();
+				if(--numberOfOpenTasks == 0)
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					work_done.notify_all();
+				}
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(mutex);
+			if(stopping)
+				return;
+			work_available.wait(lock, [this]() { return stopping || numberOfQueuedTasks > 0; });
+			if(stopping)
+				return;
+		}
+	}
+
+public:
+	explicit ThreadPool(std::size_t numberOfThreads = 0) :
+		next_queue(0), numberOfOpenTasks(0), numberOfQueuedTasks(0), numberOfStolenTasks(0), stopping(false)
+	{
+		if(numberOfThreads == 0)
+			numberOfThreads = std::max(1u, std::thread::hardware_concurrency());
+		queues = std::vector<queue_t>(numberOfThreads);
+		for(std::size_t i=0; i<numberOfThreads; ++i)
+			workers.emplace_back(&ThreadPool::work, this, i);
+	}
+	~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		work_available.notify_all();
+		for(std::thread& worker : workers)
+			worker.join();
+	}
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	std::size_t size() const { return workers.size(); }
+	long get_numberOfStolenTasks() const { return numberOfStolenTasks; }
+
+	void submit(task_t task)
+	{
+		++numberOfOpenTasks;
+		queue_t& queue = queues[next_queue++ % queues.size()];
+		{
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.tasks.push_back(std::move(task));
+			++numberOfQueuedTasks;
+		}
+		std::lock_guard<std::mutex> lock(mutex);
+		work_available.notify_one();
+	}
+
+	void wait()  // until all submitted tasks are finished
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		work_done.wait(lock, [this]() { return numberOfOpenTasks == 0; });
+	}
+
+	// function(i) for i in [0, n) - blocks until done
+	template<typename Function>
+	void parallel_for(const std::size_t& n, Function function)
+	{
+		for(std::size_t i=0; i<n; ++i)
+			submit([&function, i]() { function(i); });
+		wait();
+	}
+};
+
+#endif
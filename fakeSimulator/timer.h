@@ -8,7 +8,12 @@
 typedef std::chrono::high_resolution_clock _clock;
 typedef std::chrono::microseconds precision;
 
-static double total_duration = 0.;
+inline double& total_duration()
+{	// one instance for the whole program (a static variable in the header
+	// would give one per translation unit)
+	static double duration = 0.;
+	return duration;
+}
 
 template<typename Stream=std::ostream>
 struct Timer
@@ -21,8 +26,8 @@ struct Timer
 	~Timer()
 	{
 		const double duration = std::chrono::duration_cast<precision>(_clock::now() - start).count();
-		total_duration += duration;
-		stream << ":\t" << duration << "\t" << total_duration << '\n';
+		total_duration() += duration;
+		stream << ":\t" << duration << "\t" << total_duration() << '\n';
 	}
 private:
 	Stream& stream;
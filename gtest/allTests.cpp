@@ -1,6 +1,23 @@
 #include "gtest/gtest.h"
 //#include "gmock/gmock.h"
+#include "test_helpers.h"
 #include "test_wellDoubletControl.cpp"
+#include "test_wellDoubletControlBatch.cpp"
+#include "test_kernels.cpp"
+#include "test_warmStart.cpp"
+#include "test_acceleration.cpp"
+#include "test_statistics.cpp"
+#include "test_logger.cpp"
+#include "test_logSink.cpp"
+#include "test_threadPool.cpp"
+#include "test_grid.cpp"
+#include "test_checkpoint.cpp"
+#include "test_trace.cpp"
+#include "test_heatPump.cpp"
+#include "test_capi.cpp"
+#include "test_field.cpp"
+#include "test_wellIndex.cpp"
+#include "test_couplingDriver.cpp"
 
 
 int main(int argc, char **argv) {
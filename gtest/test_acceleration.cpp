@@ -0,0 +1,49 @@
+#include "fakeSimulator.h"
+#include "wellDoubletControl.h"
+
+class FlowrateAdaptionTest : public ::testing::TestWithParam<std::tuple<
+	char, double, double, double, double> > {};
+
+
+TEST_P(FlowrateAdaptionTest, secant_gives_same_result_with_fewer_iterations)
+{
+	FakeSimulator fixed_point, secant;
+	secant.set_flowrate_adaption(wdc::WellDoubletControl::secant);
+	expect_same_result_with_fewer_iterations(fixed_point, secant, std::get<0>(GetParam()), std::get<1>(GetParam()),
+		std::get<2>(GetParam()), std::get<3>(GetParam()), std::get<4>(GetParam()));
+}
+
+
+INSTANTIATE_TEST_CASE_P(SCHEME1, FlowrateAdaptionTest, testing::Values(
+	// input: scheme, Q_H, value_target, value_threshold, maximum ratio of iteration numbers
+	std::make_tuple(1, 1.e5, 100., 0.01, .5),  // 132 -> 44
+	std::make_tuple(1, 1.e6, 100., 0.01, .1),  // 748 -> 64
+	std::make_tuple(1, 2.e6, 100., 0.01, .75),  // 243 -> 177
+	std::make_tuple(1, -1.e5, 25., -0.01, .5),  // 146 -> 36
+	std::make_tuple(1, -5.e5, 25., -0.01, .2),  // 360 -> 43
+	std::make_tuple(1, -1.e6, 25., -0.01, 1.)  // 115 -> 114
+));
+
+
+class PowerrateAdaptionTest : public ::testing::TestWithParam<std::tuple<
+	char, double, double, double, double> > {};
+
+
+TEST_P(PowerrateAdaptionTest, newton_gives_same_result_with_fewer_iterations)
+{
+	FakeSimulator fixed_gain, newton;
+	newton.set_powerrate_adaption(wdc::WellDoubletControl::newton);
+	expect_same_result_with_fewer_iterations(fixed_gain, newton, std::get<0>(GetParam()), std::get<1>(GetParam()),
+		std::get<2>(GetParam()), std::get<3>(GetParam()), std::get<4>(GetParam()));
+	EXPECT_EQ(wdc::WellDoubletControl::powerrate_to_adapt, newton.get_wellDoubletControl()->get_result().storage_state);
+}
+
+
+INSTANTIATE_TEST_CASE_P(SCHEMES, PowerrateAdaptionTest, testing::Values(
+	// input: scheme, Q_H, value_target, value_threshold, maximum ratio of iteration numbers
+	// (with flowrate 0.01 the fixed gain is already the exact newton step of the fake simulator)
+	std::make_tuple(0, 1.e6, 0.005, 80., .5),
+	std::make_tuple(0, -1.e6, -0.005, 30., .5),
+	std::make_tuple(1, 2.e6, 100., 0.005, .7),  // flowrate adaption not accelerated
+	std::make_tuple(1, -1.e6, 25., -0.005, .5)
+));
@@ -0,0 +1,55 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "gtest/gtest.h"
+#include "wellDoubletControl.h"
+
+// own executable (run_allocationTests) - replaces the global operator new and delete
+// counts all heap allocations of the test executable
+static std::atomic<long> allocation_count(0);
+
+void* operator new(std::size_t size)
+{
+	++allocation_count;
+	if(void* pointer = std::malloc(size ? size : 1))
+		return pointer;
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+
+
+TEST(AllocationTest, no_allocations_per_time_step_after_warm_up)
+{
+	const wdc::WellDoubletControl::balancing_properties_t properties[] = {
+		{ 50., 10., 5.e6, 5.e6 }, { 120., 10., 5.e6, 5.e6 }, { 20., 50., 5.e6, 5.e6 } };
+
+	for(int scheme=0; scheme<3; ++scheme)
+	{
+		wdc::WellDoubletControl* wellDoubletControl =
+			wdc::WellDoubletControl::create_wellDoubletControl(scheme, 10., { 0.01, 10., 1.e-6 });
+		wellDoubletControl->set_heatPump(1, 70., 0.5);
+
+		// warm-up
+		wellDoubletControl->configure(1.e6, 100., 0.01, properties[0]);
+		wellDoubletControl->evaluate_simulation_result(properties[1]);
+
+		const long allocations = allocation_count;
+		for(int timeStep=0; timeStep<10; ++timeStep)
+		{
+			const double Q_H = (timeStep % 2 == 0) ? 1.e6 : -1.e6;  // storing and extracting
+			wellDoubletControl->reset();
+			wellDoubletControl->configure(Q_H, (Q_H > 0) ? 100. : 25., (Q_H > 0) ? 0.01 : -0.01, properties[0]);
+			for(int iteration=0; iteration<10; ++iteration)
+			{
+				wellDoubletControl->evaluate_simulation_result(properties[iteration % 3]);
+				wellDoubletControl->converged();
+			}
+		}
+		EXPECT_EQ(allocations, allocation_count) << "scheme " << scheme;
+
+		delete wellDoubletControl;
+	}
+}
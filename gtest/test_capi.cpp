@@ -0,0 +1,109 @@
+#include <vector>
+#include "wdc_capi.h"
+#include "wellDoubletControlBatch.h"
+
+// C interface gives the results of the batch controller
+TEST(CapiTest, identical_to_batch)
+{
+	const std::size_t n = 4;
+	const wdc::WellDoubletControl::accuracies_t accuracies = { 0.01, 10., 1.e-6 };
+	const std::vector<double> Q_H = { 1.e5, 1.e6, -1.e5, -5.e5 };
+	const std::vector<double> value_target = { 100., 100., 25., 25. }, value_threshold = { 0.01, 0.01, -0.01, -0.01 };
+	std::vector<double> T_HE(n, 50.), T_UA = { 10., 10., 50., 50. }, capacity(n, 5.e6);
+
+	EXPECT_EQ(WDC_API_VERSION, wdc_api_version());
+	int error = WDC_OK;
+	wdc_handle* handle = wdc_create(1, n, 10., accuracies.temperature, accuracies.powerrate, accuracies.flowrate, &error);
+	ASSERT_TRUE(handle != nullptr);
+	EXPECT_EQ(WDC_OK, error);
+	EXPECT_EQ(n, wdc_size(handle));
+	wdc::WellDoubletControlBatch batch(1, n, 10., accuracies);
+	EXPECT_EQ(WDC_OK, wdc_set_heatPump(handle, 3, 1, 70., 0.5));
+	batch.set_heatPump(3, 1, 70., 0.5);
+	const wdc::WellDoubletControlBatch::balancing_properties_t properties =
+		{ T_HE.data(), T_UA.data(), capacity.data(), capacity.data() };
+
+	std::vector<double> Q_H_result(n), Q_W(n), Q_H_sys(n);
+	std::vector<int> storage_state(n);
+	for(int timeStep=0; timeStep<3; ++timeStep)
+	{
+		ASSERT_EQ(WDC_OK, wdc_configure_batch(handle, Q_H.data(), value_target.data(), value_threshold.data(),
+			T_HE.data(), T_UA.data(), capacity.data(), capacity.data()));
+		batch.configure(Q_H.data(), value_target.data(), value_threshold.data(), properties);
+		for(int iteration=0; iteration<10; ++iteration)
+		{
+			for(std::size_t i=0; i<n; ++i)
+				T_HE[i] = solve_heatExchanger(batch.get_powerrates()[i], batch.get_flowrates()[i], 50., T_UA[i],
+					capacity[i]);
+			int converged = -1;
+			ASSERT_EQ(WDC_OK, wdc_evaluate_batch(handle, T_HE.data(), T_UA.data(),
+				capacity.data(), capacity.data(), &converged));
+			batch.evaluate_simulation_result(properties);
+			EXPECT_EQ(batch.converged() ? 1 : 0, converged);
+
+			ASSERT_EQ(WDC_OK, wdc_get_results(handle, Q_H_result.data(), Q_W.data(), Q_H_sys.data(),
+				storage_state.data()));
+			for(std::size_t i=0; i<n; ++i)
+			{
+				EXPECT_EQ(batch.get_powerrates()[i], Q_H_result[i]);
+				EXPECT_EQ(batch.get_flowrates()[i], Q_W[i]);
+				EXPECT_EQ(batch.get_system_powerrates()[i], Q_H_sys[i]);
+				EXPECT_EQ(static_cast<int>(batch.get_storage_states()[i]), storage_state[i]);
+			}
+		}
+	}
+	EXPECT_EQ(WDC_OK, wdc_get_results(handle, nullptr, Q_W.data(), nullptr, nullptr));  // skips arrays
+	wdc_destroy(handle);
+}
+
+TEST(CapiTest, reports_errors)
+{
+	int error = WDC_OK;
+	EXPECT_TRUE(wdc_create(3, 1, 10., 0.01, 10., 1.e-6, &error) == nullptr);
+	EXPECT_EQ(WDC_ERROR_SCHEME, error);
+	EXPECT_TRUE(wdc_create(-1, 1, 10., 0.01, 10., 1.e-6, nullptr) == nullptr);
+
+	wdc_handle* handle = wdc_create(0, 2, 10., 0.01, 10., 1.e-6, nullptr);
+	ASSERT_TRUE(handle != nullptr);
+	double x[2] = { 0., 0. };
+	EXPECT_EQ(WDC_ERROR_ARGUMENT, wdc_set_heatPump(handle, 2, 1, 70., 0.5));
+	EXPECT_EQ(WDC_ERROR_ARGUMENT, wdc_set_heatPump(handle, 0, 2, 70., 0.5));
+	EXPECT_EQ(WDC_ERROR_ARGUMENT, wdc_set_heatPump(handle, 0, -1, 70., 0.5));
+	EXPECT_EQ(WDC_ERROR_ARGUMENT, wdc_configure_batch(handle, x, x, nullptr, x, x, x, x));
+	EXPECT_EQ(WDC_ERROR_ARGUMENT, wdc_evaluate_batch(nullptr, x, x, x, x, nullptr));
+	EXPECT_EQ(WDC_ERROR_ARGUMENT, wdc_get_results(nullptr, x, x, x, nullptr));
+	EXPECT_EQ(0u, wdc_size(nullptr));
+	wdc_destroy(handle);
+	wdc_destroy(nullptr);
+}
+
+TEST(CapiTest, heat_pump_is_switched_off_with_type_0)
+{
+	double Q_H = -5.e5, value_target = 25., value_threshold = -0.01, T_HE = 50., T_UA = 50., capacity = 5.e6;
+	wdc_handle* handle = wdc_create(1, 1, 10., 0.01, 10., 1.e-6, nullptr);
+	ASSERT_TRUE(handle != nullptr);
+	wdc::WellDoubletControlBatch batch(1, 1, 10., { 0.01, 10., 1.e-6 });
+	const wdc::WellDoubletControlBatch::balancing_properties_t properties = { &T_HE, &T_UA, &capacity, &capacity };
+	double Q_H_result, Q_H_sys;
+
+	ASSERT_EQ(WDC_OK, wdc_set_heatPump(handle, 0, 1, 70., 0.5));
+	batch.set_heatPump(0, 1, 70., 0.5);
+	ASSERT_EQ(WDC_OK, wdc_configure_batch(handle, &Q_H, &value_target, &value_threshold,
+		&T_HE, &T_UA, &capacity, &capacity));
+	batch.configure(&Q_H, &value_target, &value_threshold, properties);
+	ASSERT_EQ(WDC_OK, wdc_get_results(handle, &Q_H_result, nullptr, &Q_H_sys, nullptr));
+	EXPECT_GT(batch.get_COP(0), 1.);
+	EXPECT_EQ(-5.e5, Q_H_sys);
+	EXPECT_GT(Q_H_result, Q_H_sys);  // heat pump adds power
+
+	ASSERT_EQ(WDC_OK, wdc_set_heatPump(handle, 0, 0, 0., 0.));
+	batch.set_heatPump(0, 0, 0., 0.);
+	ASSERT_EQ(WDC_OK, wdc_configure_batch(handle, &Q_H, &value_target, &value_threshold,
+		&T_HE, &T_UA, &capacity, &capacity));
+	batch.configure(&Q_H, &value_target, &value_threshold, properties);
+	ASSERT_EQ(WDC_OK, wdc_get_results(handle, &Q_H_result, nullptr, &Q_H_sys, nullptr));
+	EXPECT_EQ(-1., batch.get_COP(0));
+	EXPECT_EQ(-5.e5, Q_H_sys);
+	EXPECT_EQ(Q_H_sys, Q_H_result);
+	wdc_destroy(handle);
+}
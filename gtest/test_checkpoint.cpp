@@ -0,0 +1,200 @@
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include "checkpoint.h"
+
+static void run_iterations(wdc::WellDoubletControl* wellDoubletControl, double& T_HE, const int& n)
+{
+	const double T_UA = 50.;
+	for(int i=0; i<n; ++i)
+	{
+		const wdc::WellDoubletControl::result_t result = wellDoubletControl->get_result();
+		T_HE = solve_heatExchanger(result.Q_H, result.Q_W, 40., T_UA);
+		wellDoubletControl->evaluate_simulation_result({ T_HE, T_UA, 5.e6, 5.e6 });
+	}
+}
+
+
+TEST(CheckpointTest, restored_controller_continues_identically)
+{
+	const wdc::WellDoubletControl::accuracies_t accuracies = { 0.01, 10., 1.e-6 };
+	wdc::WellDoubletControl* original = wdc::WellDoubletControl::create_wellDoubletControl(1, 10., accuracies);
+	original->set_heatPump(1, 70., 0.5);
+	original->set_warm_start(true);
+	original->set_flowrate_adaption(wdc::WellDoubletControl::secant);
+	original->set_powerrate_adaption(wdc::WellDoubletControl::newton);
+
+	double T_HE = 40.;
+	original->configure(-5.e5, 25., -0.01, { T_HE, 50., 5.e6, 5.e6 });
+	run_iterations(original, T_HE, 3);  // mid time step - iterates are set
+
+	std::vector<char> buffer(wdc::get_checkpoint_size(1));
+	wdc::write_checkpoint(&original, 1, buffer.data());
+	wdc::WellDoubletControl* restored = nullptr;  // created from record
+	ASSERT_TRUE(wdc::read_checkpoint(buffer.data(), buffer.size(), &restored, 1));
+	ASSERT_NE(nullptr, restored);
+	EXPECT_EQ(1, restored->get_scheme_ID());
+	EXPECT_TRUE(restored->get_warm_start());
+	EXPECT_EQ(wdc::WellDoubletControl::secant, restored->get_flowrate_adaption());
+	EXPECT_EQ(original->get_COP(), restored->get_COP());
+
+	double T_HE_restored = T_HE;
+	for(int timeStep=0; timeStep<3; ++timeStep)
+	{
+		run_iterations(original, T_HE, 10);
+		run_iterations(restored, T_HE_restored, 10);
+		const wdc::WellDoubletControl::result_t a = original->get_result(), b = restored->get_result();
+		EXPECT_EQ(a.Q_H, b.Q_H);
+		EXPECT_EQ(a.Q_W, b.Q_W);
+		EXPECT_EQ(a.Q_H_sys, b.Q_H_sys);
+		EXPECT_EQ(a.storage_state, b.storage_state);
+		EXPECT_EQ(original->converged(), restored->converged());
+		original->configure(-5.e5, 25., -0.01, { T_HE, 50., 5.e6, 5.e6 });  // warm start
+		restored->configure(-5.e5, 25., -0.01, { T_HE_restored, 50., 5.e6, 5.e6 });
+	}
+	delete original;
+	delete restored;
+}
+
+TEST(CheckpointTest, arrays_and_batches_in_one_file)
+{
+	const wdc::WellDoubletControl::accuracies_t accuracies = { 0.01, 10., 1.e-6 };
+	const std::size_t n = 1000;
+	const char* path = "test_checkpoint.bin";
+
+	wdc::WellDoubletControlBatch batch(2, n, 10., accuracies);
+	std::vector<double> Q_H(n), target(n, 450.e6), threshold(n, 0.01), T_HE(n), T_UA(n, 10.), capacity(n, 5.e6);
+	for(std::size_t i=0; i<n; ++i)
+	{
+		Q_H[i] = 1.e5 * (1 + i % 20);
+		T_HE[i] = 20. + i % 30;
+	}
+	const wdc::WellDoubletControlBatch::balancing_properties_t properties =
+		{ T_HE.data(), T_UA.data(), capacity.data(), capacity.data() };
+	batch.configure(Q_H.data(), target.data(), threshold.data(), properties);
+	batch.evaluate_simulation_result(properties);
+
+	ASSERT_TRUE(wdc::save_checkpoint(path, batch));
+	wdc::WellDoubletControlBatch restored(2, n, 1., { 1., 1., 1. });
+	ASSERT_TRUE(wdc::load_checkpoint(path, restored));
+	EXPECT_EQ(accuracies.flowrate, restored.get_accuracies().flowrate);
+
+	// into single controllers - same records
+	std::vector<wdc::WellDoubletControl*> controllers(n, nullptr);
+	ASSERT_TRUE(wdc::load_checkpoint(path, controllers.data(), n));
+	for(std::size_t i=0; i<n; ++i)
+	{
+		EXPECT_EQ(batch.get_result(i).Q_W, restored.get_result(i).Q_W);
+		EXPECT_EQ(batch.get_result(i).Q_W, controllers[i]->get_result().Q_W);
+	}
+
+	for(std::size_t i=0; i<n; ++i)
+		T_HE[i] += 1.;
+	batch.evaluate_simulation_result(properties);
+	restored.evaluate_simulation_result(properties);
+	for(std::size_t i=0; i<n; ++i)
+	{
+		controllers[i]->evaluate_simulation_result({ T_HE[i], T_UA[i], capacity[i], capacity[i] });
+		EXPECT_EQ(batch.get_result(i).Q_W, restored.get_result(i).Q_W);
+		EXPECT_EQ(batch.get_result(i).Q_H, restored.get_result(i).Q_H);
+		EXPECT_EQ(batch.get_result(i).Q_W, controllers[i]->get_result().Q_W);
+		EXPECT_EQ(batch.converged(i), restored.converged(i));
+	}
+
+	// controller array back into the file
+	ASSERT_TRUE(wdc::save_checkpoint(path, controllers.data(), n));
+	wdc::WellDoubletControlBatch reloaded(2, n, 10., accuracies);
+	ASSERT_TRUE(wdc::load_checkpoint(path, reloaded));
+	for(std::size_t i=0; i<n; ++i)
+		EXPECT_EQ(controllers[i]->get_result().Q_H, reloaded.get_result(i).Q_H);
+
+	for(wdc::WellDoubletControl* controller : controllers)
+		delete controller;
+	std::remove(path);
+}
+
+TEST(CheckpointTest, rejects_foreign_buffers)
+{
+	wdc::WellDoubletControl* controller = wdc::WellDoubletControl::create_wellDoubletControl(0, 10., { 0.01, 10., 1.e-6 });
+	std::vector<char> buffer(wdc::get_checkpoint_size(1));
+	wdc::write_checkpoint(&controller, 1, buffer.data());
+	EXPECT_EQ(1u, wdc::get_numberOfRecords(buffer.data(), buffer.size()));
+	EXPECT_EQ(0u, wdc::get_numberOfRecords(buffer.data(), buffer.size() - 1));  // truncated
+
+	wdc::WellDoubletControl* other = wdc::WellDoubletControl::create_wellDoubletControl(1, 10., { 0.01, 10., 1.e-6 });
+	EXPECT_FALSE(wdc::read_checkpoint(buffer.data(), buffer.size(), &other, 1));  // scheme differs
+	wdc::WellDoubletControlBatch batch(0, 2, 10., { 0.01, 10., 1.e-6 });
+	EXPECT_FALSE(wdc::read_checkpoint(buffer.data(), buffer.size(), batch));  // number differs
+
+	std::vector<char> changed = buffer;
+	changed[4] = 99;  // version
+	EXPECT_EQ(0u, wdc::get_numberOfRecords(changed.data(), changed.size()));
+	changed = buffer;
+	changed[0] = 'X';
+	EXPECT_FALSE(wdc::read_checkpoint(changed.data(), changed.size(), &controller, 1));
+	EXPECT_FALSE(wdc::load_checkpoint("does_not_exist.bin", &controller, 1));
+
+	delete controller;
+	delete other;
+}
+
+TEST(CheckpointTest, rejects_enums_out_of_range)
+{
+	const wdc::WellDoubletControl::accuracies_t accuracies = { 0.01, 10., 1.e-6 };
+	wdc::WellDoubletControl* controllers[2] = { wdc::WellDoubletControl::create_wellDoubletControl(1, 10., accuracies),
+			wdc::WellDoubletControl::create_wellDoubletControl(1, 10., accuracies) };
+	controllers[0]->configure(1.e5, 50., 0.01, { 20., 10., 5.e6, 5.e6 });
+	std::vector<char> buffer(wdc::get_checkpoint_size(2));
+	wdc::write_checkpoint(controllers, 2, buffer.data());
+	wdc::checkpoint_t* records = reinterpret_cast<wdc::checkpoint_t*>(buffer.data() + sizeof(wdc::checkpoint_header_t));
+	const wdc::checkpoint_t record = records[1];
+
+	std::int32_t wdc::checkpoint_t::* const fields[] = { &wdc::checkpoint_t::storage_state,
+		&wdc::checkpoint_t::operationType, &wdc::checkpoint_t::heatPump_type,
+		&wdc::checkpoint_t::flowrate_adaption, &wdc::checkpoint_t::powerrate_adaption };
+	wdc::WellDoubletControl* restored[2] = { nullptr, nullptr };
+	for(std::int32_t wdc::checkpoint_t::* field : fields)
+		for(const std::int32_t value : { -1, 4 })
+		{
+			records[1] = record;
+			records[1].*field = value;
+			EXPECT_FALSE(wdc::read_checkpoint(buffer.data(), buffer.size(), restored, 2));
+			EXPECT_EQ(nullptr, restored[0]);  // nothing restored
+			EXPECT_FALSE(wdc::read_checkpoint(buffer.data(), buffer.size(), controllers, 2));
+		}
+	EXPECT_EQ(0., controllers[1]->get_result().Q_H);
+
+	records[1] = record;
+	EXPECT_TRUE(wdc::read_checkpoint(buffer.data(), buffer.size(), restored, 2));
+	EXPECT_EQ(controllers[0]->get_result().Q_W, restored[0]->get_result().Q_W);
+
+	for(wdc::WellDoubletControl* controller : { controllers[0], controllers[1], restored[0], restored[1] })
+		delete controller;
+}
+
+TEST(CheckpointTest, batch_stores_heat_sink_of_heat_pump)
+{
+	const wdc::WellDoubletControl::accuracies_t accuracies = { 0.01, 10., 1.e-6 };
+	wdc::WellDoubletControl* controller = wdc::WellDoubletControl::create_wellDoubletControl(1, 10., accuracies);
+	wdc::WellDoubletControlBatch batch(1, 1, 10., accuracies);
+	controller->set_heatPump(1, 70., 0.5);
+	batch.set_heatPump(0, 1, 70., 0.5);
+
+	double Q_H = -5.e5, target = 25., threshold = -0.01, T_HE = 30., T_UA = 30., capacity = 5.e6;
+	const wdc::WellDoubletControlBatch::balancing_properties_t properties = { &T_HE, &T_UA, &capacity, &capacity };
+	controller->configure(Q_H, target, threshold, { T_HE, T_UA, capacity, capacity });
+	batch.configure(&Q_H, &target, &threshold, properties);
+	for(int i=0; i<3; ++i)
+	{
+		T_HE = solve_heatExchanger(controller->get_result().Q_H, controller->get_result().Q_W, T_HE, T_UA);
+		controller->evaluate_simulation_result({ T_HE, T_UA, capacity, capacity });
+		batch.evaluate_simulation_result(properties);
+	}
+
+	std::vector<char> single(wdc::get_checkpoint_size(1)), batched(wdc::get_checkpoint_size(1));
+	wdc::write_checkpoint(&controller, 1, single.data());
+	wdc::write_checkpoint(batch, batched.data());
+	EXPECT_NE(0., wdc::get_records(single.data())->heatPump_heat_sink);
+	EXPECT_EQ(wdc::get_records(single.data())->heatPump_heat_sink, wdc::get_records(batched.data())->heatPump_heat_sink);
+	delete controller;
+}
@@ -0,0 +1,201 @@
+#include <vector>
+#include "couplingDriver.h"
+
+// host solving one node heat exchanger model (solve_heatExchanger) for the driver
+static double solve_request(const wdc::CouplingDriver& driver, const double& T_previous, const double& T_UA)
+{
+	const wdc::CouplingDriver::request_t request = driver.get_request();
+	return solve_heatExchanger(request.Q_H, request.Q_W, T_previous, T_UA);
+}
+
+
+TEST(CouplingDriverTest, interleaved_drivers_equal_sequential_loops)
+{
+	const wdc::WellDoubletControl::accuracies_t accuracies = { 0.01, 10., 1.e-6 };
+	struct scenario_t { int scheme; double Q_H, value_target, value_threshold, T_UA; };
+	const std::vector<scenario_t> scenarios = {
+		{ 0, 1.e6, 0.01, 80., 10. }, { 1, 1.e6, 100., 0.01, 10. }, { 1, -5.e5, 25., -0.01, 50. },
+		{ 2, 2.e6, 450.e6, 0.01, 10. } };
+	const std::size_t n = scenarios.size();
+
+	// sequential: loop of FakeSimulator::execute_timeStep per doublet
+	std::vector<wdc::WellDoubletControl::result_t> expected(n);
+	std::vector<int> expected_iterations(n);
+	for(std::size_t k=0; k<n; ++k)
+	{
+		const scenario_t& s = scenarios[k];
+		wdc::WellDoubletControl* wellDoubletControl =
+			wdc::WellDoubletControl::create_wellDoubletControl(s.scheme, 10., accuracies);
+		wellDoubletControl->configure(s.Q_H, s.value_target, s.value_threshold, { 40., s.T_UA, 5.e6, 5.e6 });
+		double T_HE = 40., T_HE_previous = 40.;
+		int i;
+		for(i=0; i<200; i++)
+		{
+			const wdc::WellDoubletControl::result_t result = wellDoubletControl->get_result();
+			T_HE = solve_heatExchanger(result.Q_H, result.Q_W, 40., s.T_UA);
+			wellDoubletControl->evaluate_simulation_result({ T_HE, s.T_UA, 5.e6, 5.e6 });
+			const double error = fabs(T_HE - T_HE_previous);
+			T_HE_previous = T_HE;
+			if(i >= 1 && error < 0.01 && wellDoubletControl->converged())
+				break;
+		}
+		expected[k] = wellDoubletControl->get_result();
+		expected_iterations[k] = std::min(i+1, 200);
+		delete wellDoubletControl;
+	}
+
+	// interleaved: one batched "solve" for all doublets which request it, then errors - one thread
+	std::vector<wdc::WellDoubletControl*> controllers(n);
+	std::vector<wdc::CouplingDriver> drivers(n);
+	std::vector<double> T_HE(n, 40.), T_HE_previous(n, 40.);
+	for(std::size_t k=0; k<n; ++k)
+	{
+		const scenario_t& s = scenarios[k];
+		controllers[k] = wdc::WellDoubletControl::create_wellDoubletControl(s.scheme, 10., accuracies);
+		EXPECT_EQ(wdc::CouplingDriver::idle, drivers[k].get_state());
+		drivers[k].start(controllers[k], s.Q_H, s.value_target, s.value_threshold, { 40., s.T_UA, 5.e6, 5.e6 });
+	}
+	std::size_t finished = 0;
+	while(finished < n)
+	{
+		for(std::size_t k=0; k<n; ++k)
+			if(drivers[k].get_state() == wdc::CouplingDriver::solve)
+				T_HE[k] = solve_request(drivers[k], 40., scenarios[k].T_UA);
+		finished = 0;
+		for(std::size_t k=0; k<n; ++k)
+		{
+			if(drivers[k].get_state() == wdc::CouplingDriver::solve &&
+					drivers[k].evaluate({ T_HE[k], scenarios[k].T_UA, 5.e6, 5.e6 }) == wdc::CouplingDriver::error)
+				drivers[k].check(fabs(T_HE[k] - T_HE_previous[k]));
+			T_HE_previous[k] = T_HE[k];
+			finished += drivers[k].finished();
+		}
+	}
+	for(std::size_t k=0; k<n; ++k)
+	{
+		EXPECT_EQ(expected[k].Q_H, drivers[k].get_wellDoubletControl()->get_result().Q_H);
+		EXPECT_EQ(expected[k].Q_W, drivers[k].get_wellDoubletControl()->get_result().Q_W);
+		EXPECT_EQ(expected_iterations[k], drivers[k].get_numberOfIterations());
+		delete controllers[k];
+	}
+}
+
+TEST(CouplingDriverTest, stops_at_maximum_number_of_iterations)
+{
+	const wdc::WellDoubletControl::accuracies_t accuracies = { 0.01, 10., 1.e-6 };
+	wdc::WellDoubletControl* wellDoubletControl = wdc::WellDoubletControl::create_wellDoubletControl(1, 10., accuracies);
+	wdc::CouplingDriver driver(3, 5, 0.01);
+	driver.start(wellDoubletControl, 1.e6, 100., 0.01, { 40., 10., 5.e6, 5.e6 });
+
+	int solves = 0, checks = 0;
+	while(!driver.finished())
+	{
+		if(driver.get_state() == wdc::CouplingDriver::solve)
+		{
+			++solves;
+			driver.evaluate({ 40. + solves, 10., 5.e6, 5.e6 });
+		}
+		else
+		{
+			++checks;
+			EXPECT_EQ(wdc::CouplingDriver::error, driver.get_state());
+			EXPECT_EQ(wdc::CouplingDriver::error, driver.evaluate({ 0., 0., 0., 0. }));  // ignored
+			driver.check(1.);  // never converges
+		}
+	}
+	EXPECT_EQ(wdc::CouplingDriver::not_converged, driver.get_state());
+	EXPECT_EQ(5, solves);
+	EXPECT_EQ(4, checks);  // not after first iteration
+	EXPECT_EQ(5, driver.get_iteration());
+	EXPECT_EQ(5, driver.get_numberOfIterations());
+	delete wellDoubletControl;
+}
+
+TEST(CouplingDriverTest, adaptive_tolerance_is_restored_when_finished)
+{
+	const wdc::WellDoubletControl::accuracies_t accuracies = { 0.01, 10., 1.e-6 };
+	wdc::WellDoubletControl* wellDoubletControl = wdc::WellDoubletControl::create_wellDoubletControl(1, 10., accuracies);
+	wdc::CouplingDriver driver(3, 5, 0.01);
+	driver.set_tolerance(wdc::CouplingDriver::adaptive_tolerance);
+	driver.start(wellDoubletControl, 1.e6, 100., 0.01, { 40., 10., 5.e6, 5.e6 });
+
+	int solves = 0;
+	while(!driver.finished())
+	{
+		if(driver.get_state() == wdc::CouplingDriver::solve)
+			driver.evaluate({ 40. + ++solves, 10., 5.e6, 5.e6 });
+		else
+		{
+			driver.check(1.);  // never converges
+			if(!driver.finished())
+			{	// loosened by forcing term 0.9 (eta_max, error does not decrease)
+				EXPECT_DOUBLE_EQ(0.9, driver.get_forcingTerm());
+				EXPECT_DOUBLE_EQ(0.9, wellDoubletControl->get_accuracies().temperature);
+				EXPECT_EQ(accuracies.powerrate, wellDoubletControl->get_accuracies().powerrate);
+				EXPECT_EQ(accuracies.flowrate, wellDoubletControl->get_accuracies().flowrate);
+			}
+		}
+	}
+	EXPECT_EQ(wdc::CouplingDriver::not_converged, driver.get_state());
+	EXPECT_EQ(accuracies.temperature, wellDoubletControl->get_accuracies().temperature);
+
+	// converged with accuracies of the controller
+	wdc::CouplingDriver converging;
+	converging.set_tolerance(wdc::CouplingDriver::adaptive_tolerance);
+	converging.start(wellDoubletControl, 1.e6, 100., 0.01, { 40., 10., 5.e6, 5.e6 });
+	double T_HE = 40., T_HE_previous = 40.;
+	while(!converging.finished())
+	{
+		if(converging.get_state() == wdc::CouplingDriver::solve)
+		{
+			T_HE = solve_request(converging, 40., 10.);
+			converging.evaluate({ T_HE, 10., 5.e6, 5.e6 });
+		}
+		else
+		{
+			converging.check(fabs(T_HE - T_HE_previous));
+			EXPECT_LE(accuracies.temperature, wellDoubletControl->get_accuracies().temperature);
+		}
+		T_HE_previous = T_HE;
+	}
+	EXPECT_EQ(wdc::CouplingDriver::converged, converging.get_state());
+	EXPECT_EQ(accuracies.temperature, wellDoubletControl->get_accuracies().temperature);
+	EXPECT_TRUE(wellDoubletControl->converged());
+
+	// started again while iterating with loosened tolerance - restored before taken as accuracies
+	driver.start(wellDoubletControl, 1.e6, 100., 0.01, { 40., 10., 5.e6, 5.e6 });
+	for(int i=0; i<2; ++i)
+		driver.evaluate({ 41. + i, 10., 5.e6, 5.e6 });
+	driver.check(1.);
+	ASSERT_EQ(wdc::CouplingDriver::solve, driver.get_state());
+	EXPECT_DOUBLE_EQ(0.9, wellDoubletControl->get_accuracies().temperature);
+	driver.start(wellDoubletControl, 1.e6, 100., 0.01, { 40., 10., 5.e6, 5.e6 });
+	EXPECT_EQ(accuracies.temperature, wellDoubletControl->get_accuracies().temperature);
+	for(int i=0; i<2; ++i)
+		driver.evaluate({ 41. + i, 10., 5.e6, 5.e6 });
+	driver.check(.5);
+	EXPECT_DOUBLE_EQ(0.45, wellDoubletControl->get_accuracies().temperature);  // eta_max * error, not 0.9
+	delete wellDoubletControl;
+}
+
+TEST(CouplingDriverTest, resumed_driver_continues_iterations)
+{
+	const wdc::WellDoubletControl::accuracies_t accuracies = { 0.01, 10., 1.e-6 };
+	wdc::WellDoubletControl* wellDoubletControl = wdc::WellDoubletControl::create_wellDoubletControl(0, 10., accuracies);
+	wdc::CouplingDriver driver(3, 10, 0.01);
+	driver.start(wellDoubletControl, 1.e6, 0.01, 80., { 40., 10., 5.e6, 5.e6 });
+	driver.resume();  // ignored if not converged
+	EXPECT_EQ(wdc::CouplingDriver::solve, driver.get_state());
+	while(driver.get_state() == wdc::CouplingDriver::solve)
+		driver.evaluate({ 40., 10., 5.e6, 5.e6 });
+	ASSERT_EQ(wdc::CouplingDriver::converged, driver.check(0.));
+	EXPECT_EQ(2, driver.get_numberOfIterations());
+
+	driver.resume();  // another doublet of the field did not converge
+	EXPECT_EQ(wdc::CouplingDriver::solve, driver.get_state());
+	EXPECT_EQ(2, driver.get_iteration());
+	EXPECT_EQ(wdc::CouplingDriver::error, driver.evaluate({ 40., 10., 5.e6, 5.e6 }));
+	EXPECT_EQ(wdc::CouplingDriver::converged, driver.check(0.));
+	EXPECT_EQ(3, driver.get_numberOfIterations());
+	delete wellDoubletControl;
+}
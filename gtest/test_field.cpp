@@ -0,0 +1,134 @@
+#include <chrono>
+#include <thread>
+#include "fieldSimulator.h"
+
+
+TEST(FieldTest, doublets_heat_and_cool_the_field)
+{
+	QuietOutput quiet;  // WDC_LOG of simulators
+
+	FieldSimulator field;
+	field.set_grid(40, 20);
+	EXPECT_FALSE(field.add_doublet(0, 5, 10, 5, 1, 1.e6, 100., 0.01));  // on boundary
+	EXPECT_FALSE(field.add_doublet(5, 5, 5, 5, 1, 1.e6, 100., 0.01));  // same cell
+	ASSERT_TRUE(field.add_doublet(5, 10, 15, 10, 1, 1.e6, 100., 0.01));  // storing
+	ASSERT_TRUE(field.add_doublet(25, 10, 35, 10, 1, -5.e5, 25., -0.01));  // extracting
+	field.simulate();
+
+	EXPECT_EQ(2u, field.get_numberOfDoublets());
+	EXPECT_GT(field.get_numberOfIterations(), c_numberOfTimeSteps);
+	EXPECT_GT(field.get_temperature(5, 10), c_temperature_storage_initial);  // warm plume
+	EXPECT_GT(field.get_temperature(5, 11), c_temperature_storage_initial);
+	EXPECT_LT(field.get_temperature(35, 10), c_temperature_storage_initial);  // cold plume
+	EXPECT_EQ(c_temperature_storage_initial, field.get_temperature(0, 10));  // boundary
+	for(std::size_t i=0; i<field.get_numberOfDoublets(); ++i)
+		EXPECT_TRUE(field.get_wellDoubletControl(i)->converged());
+	// controller sees the field
+	EXPECT_EQ(field.get_temperature(5, 10), field.get_wellDoubletControl(0)->get_result().T_HE);
+	EXPECT_EQ(field.get_temperature(15, 10), field.get_wellDoubletControl(0)->get_result().T_UA);
+}
+
+TEST(FieldTest, neighbouring_plumes_interfere)
+{
+	QuietOutput quiet;  // WDC_LOG of simulators
+
+	FieldSimulator alone, neighbours;
+	for(FieldSimulator* field : { &alone, &neighbours })
+	{
+		field->set_grid(30, 30);
+		field->set_diffusivity(2.e-3);
+		field->set_numberOfTimeSteps(20);
+		field->add_doublet(10, 15, 20, 15, 1, 1.e6, 100., 0.01);
+	}
+	neighbours.add_doublet(12, 15, 12, 25, 1, 1.e6, 100., 0.01);  // warm well next to the first one
+	alone.simulate();
+	neighbours.simulate();
+
+	EXPECT_GT(neighbours.get_temperature(11, 15), alone.get_temperature(11, 15));
+	EXPECT_NE(alone.get_wellDoubletControl(0)->get_result().Q_W,
+		neighbours.get_wellDoubletControl(0)->get_result().Q_W);
+}
+
+TEST(FieldTest, strips_across_threads_give_identical_results)
+{
+	QuietOutput quiet;  // WDC_LOG of simulators
+
+	FieldSimulator serial, parallel;
+	parallel.set_numberOfThreads(4);
+	for(FieldSimulator* field : { &serial, &parallel })
+	{
+		field->set_grid(512, 300);  // above c_minimumNumberOfNodesPerThread per thread
+		field->set_numberOfTimeSteps(3);
+		for(std::size_t k=0; k<8; ++k)
+			field->add_doublet(20 + 60 * k, 50 + 25 * k, 40 + 60 * k, 50 + 25 * k, 1,
+				(k % 2) ? -5.e5 : 1.e6, (k % 2) ? 25. : 100., (k % 2) ? -0.01 : 0.01);
+	}
+	serial.simulate();
+	parallel.simulate();
+
+	EXPECT_EQ(serial.get_numberOfIterations(), parallel.get_numberOfIterations());
+	std::size_t different = 0;
+	for(std::size_t c=0; c<512*300; ++c)
+		different += (serial.get_temperatures()[c] != parallel.get_temperatures()[c]);
+	EXPECT_EQ(0u, different);
+	for(std::size_t i=0; i<8; ++i)
+		EXPECT_EQ(serial.get_wellDoubletControl(i)->get_result().Q_W,
+			parallel.get_wellDoubletControl(i)->get_result().Q_W);
+}
+
+TEST(FieldTest, pipelined_controllers_give_identical_results)
+{
+	QuietOutput quiet;  // WDC_LOG of simulators
+
+	FieldSimulator serial, pipelined;
+	pipelined.set_numberOfControllerThreads(3);
+	for(FieldSimulator* field : { &serial, &pipelined })
+	{
+		field->set_grid(60, 60);
+		field->set_numberOfTimeSteps(5);
+		for(std::size_t k=0; k<16; ++k)
+			field->add_doublet(5 + 12 * (k % 4), 5 + 12 * (k / 4), 10 + 12 * (k % 4), 10 + 12 * (k / 4), k % 3,
+				(k % 2) ? -5.e5 : 1.e6, (k % 2) ? (k % 3 == 2 ? -125.e6 : (k % 3 ? 25. : -0.01)) :
+					(k % 3 == 2 ? 450.e6 : (k % 3 ? 100. : 0.01)),
+				(k % 2) ? (k % 3 ? -0.01 : 30.) : (k % 3 ? 0.01 : 100.));
+	}
+	serial.simulate();
+	pipelined.simulate();
+
+	EXPECT_EQ(serial.get_numberOfIterations(), pipelined.get_numberOfIterations());
+	for(std::size_t i=0; i<serial.get_numberOfDoublets(); ++i)
+	{
+		EXPECT_EQ(serial.get_wellDoubletControl(i)->get_result().Q_W,
+			pipelined.get_wellDoubletControl(i)->get_result().Q_W);
+		EXPECT_EQ(serial.get_wellDoubletControl(i)->get_result().Q_H,
+			pipelined.get_wellDoubletControl(i)->get_result().Q_H);
+	}
+	for(std::size_t c=0; c<60*60; ++c)
+		ASSERT_EQ(serial.get_temperatures()[c], pipelined.get_temperatures()[c]);
+
+	const CouplingPipeline::statistics_t statistics = pipelined.get_pipelineStatistics();
+	EXPECT_EQ(long(pipelined.get_numberOfIterations()) * 16, statistics.numberOfItems);
+	EXPECT_LE(statistics.occupancy_max, 64u);
+	EXPECT_GE(statistics.occupancy_mean, 0.);
+	EXPECT_GE(statistics.drain_wait, 0.);
+	EXPECT_EQ(0, serial.get_pipelineStatistics().numberOfItems);
+}
+
+TEST(FieldTest, idle_controller_threads_sleep_until_push)
+{
+	QuietOutput quiet;  // WDC_LOG of controllers
+
+	CouplingPipeline pipeline(2);
+	for(int i=0; i<1000 && pipeline.get_numberOfSleepingThreads() < 2; ++i)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	EXPECT_EQ(2u, pipeline.get_numberOfSleepingThreads());
+
+	wdc::WellDoubletControl* wellDoubletControl =
+		wdc::WellDoubletControl::create_wellDoubletControl(0, 10., { 0.01, 10., 1.e-6 });
+	wdc::CouplingDriver driver;
+	driver.start(wellDoubletControl, 1.e6, 0.01, 80., { 40., 10., 5.e6, 5.e6 });
+	pipeline.push(1, { &driver, { 40., 10., 5.e6, 5.e6 } });  // wakes second thread
+	pipeline.wait();
+	EXPECT_EQ(1, driver.get_iteration());
+	delete wellDoubletControl;
+}  // destructor wakes threads to stop
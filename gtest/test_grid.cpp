@@ -0,0 +1,98 @@
+#include <cstdint>
+#include "fakeSimulator.h"
+
+
+TEST(GridTest, runtime_grid_is_aligned_and_keeps_heat_exchanger_results)
+{
+	QuietOutput quiet;  // WDC_LOG of simulators
+
+	FakeSimulator simulator, large;
+	simulator.set_logFile("");
+	large.set_logFile("");
+	large.set_gridSize(100000);
+	simulator.simulate(1, -5.e5, 25., -0.01);
+	large.simulate(1, -5.e5, 25., -0.01);
+
+	EXPECT_EQ(std::size_t(c_gridSize), simulator.get_gridSize());
+	EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(large.get_temperatures()) % 64);
+	// heat exchanger is upwind of the added nodes
+	EXPECT_EQ(simulator.get_wellDoubletControl()->get_result().Q_W, large.get_wellDoubletControl()->get_result().Q_W);
+	EXPECT_EQ(simulator.get_wellDoubletControl()->get_result().T_HE, large.get_wellDoubletControl()->get_result().T_HE);
+	EXPECT_EQ(simulator.get_temperatures()[c_gridSize-1], large.get_temperatures()[c_gridSize-1]);
+
+	large.set_gridSize(1);  // heat exchanger node is kept
+	EXPECT_EQ(std::size_t(c_heatExchanger_nodeNumber + 1), large.get_gridSize());
+}
+
+TEST(GridTest, large_grid_split_across_threads_gives_identical_results)
+{
+	QuietOutput quiet;  // WDC_LOG of simulators
+
+	const std::size_t gridSize = 4 * c_minimumNumberOfNodesPerThread + 13;
+	FakeSimulator serial, parallel;
+	serial.set_logFile("");
+	parallel.set_logFile("");
+	serial.set_gridSize(gridSize);
+	parallel.set_gridSize(gridSize);
+	parallel.set_numberOfThreads(4);
+	serial.simulate(0, 1.e6, 0.01, 80.);
+	parallel.simulate(0, 1.e6, 0.01, 80.);
+
+	EXPECT_EQ(serial.get_numberOfIterations(), parallel.get_numberOfIterations());
+	EXPECT_EQ(serial.get_wellDoubletControl()->get_result().Q_H, parallel.get_wellDoubletControl()->get_result().Q_H);
+	for(std::size_t i=0; i<gridSize; ++i)
+		ASSERT_EQ(serial.get_temperatures()[i], parallel.get_temperatures()[i]) << "node " << i;
+}
+
+TEST(GridTest, implicit_solver_takes_day_sized_time_steps)
+{
+	QuietOutput quiet;  // WDC_LOG of simulators
+
+	FakeSimulator simulator;
+	simulator.set_logFile("");
+	simulator.set_gridSize(200);
+	simulator.set_solver(FakeSimulator::implicit_upwind);
+	simulator.set_diffusivity(1.e-6);
+	simulator.set_timeStepSize(86400.);  // courant number of several hundred
+	simulator.simulate(0, 1.e3, 0.01, 80.);
+
+	EXPECT_LT(simulator.get_numberOfIterations(), c_numberOfTimeSteps * c_maxNumberOfIterations);
+	for(std::size_t i=0; i<simulator.get_gridSize(); ++i)
+	{	// stable - bounded by inlet and heat exchanger temperature
+		EXPECT_GE(simulator.get_temperatures()[i], c_temperature_storage_initial - 1.e-9);
+		EXPECT_LE(simulator.get_temperatures()[i], 80. + 1.);
+	}
+}
+
+TEST(GridTest, implicit_solver_matches_explicit_solver_at_small_courant_number)
+{
+	QuietOutput quiet;  // WDC_LOG of simulators
+
+	// both upwind schemes are first order in time - difference halves with time step size
+	double difference[2];
+	const double timeStepSizes[2] = { 10., 5. };  // courant number 0.05, 0.025 (Q_W 0.01)
+	for(int k=0; k<2; ++k)
+	{
+		FakeSimulator explicit_simulator, implicit_simulator;
+		for(FakeSimulator* simulator : { &explicit_simulator, &implicit_simulator })
+		{
+			simulator->set_logFile("");
+			simulator->set_gridSize(50);
+			simulator->set_timeStepSize(timeStepSizes[k]);
+			simulator->set_numberOfTimeSteps(static_cast<int>(1000. / timeStepSizes[k]));  // same time
+		}
+		implicit_simulator.set_solver(FakeSimulator::implicit_upwind);  // without diffusion
+		explicit_simulator.simulate(0, 1.e3, 0.01, 80.);
+		implicit_simulator.simulate(0, 1.e3, 0.01, 80.);
+
+		EXPECT_EQ(explicit_simulator.get_wellDoubletControl()->get_result().Q_W,
+			implicit_simulator.get_wellDoubletControl()->get_result().Q_W);
+		difference[k] = 0.;
+		for(std::size_t i=0; i<explicit_simulator.get_gridSize(); ++i)
+			difference[k] = std::max(difference[k],
+				fabs(explicit_simulator.get_temperatures()[i] - implicit_simulator.get_temperatures()[i]));
+	}
+	EXPECT_LT(difference[0], 1.e-2);
+	EXPECT_GT(difference[0], 0.);  // solvers differ
+	EXPECT_NEAR(0.5, difference[1] / difference[0], 0.05);
+}
@@ -0,0 +1,185 @@
+#include <vector>
+#include <cstdio>
+#include <fstream>
+#include "heatPump.h"
+#include "wellDoubletControl.h"
+#include "wellDoubletControlBatch.h"
+
+// non-uniform axes: source 0, 10, 15, 30 - sink 35, 45, 55
+static std::shared_ptr<const wdc::COPTable> make_COPTable()
+{
+	return wdc::COPTable::create({ 0., 10., 15., 30. }, { 35., 45., 55. },
+		{ 4.0, 3.2, 2.6,
+		  5.0, 4.0, 3.1,
+		  5.6, 4.4, 3.4,
+		  7.0, 5.5, 4.2 });
+}
+
+
+TEST(HeatPumpTest, table_interpolates_bilinearly)
+{
+	const std::shared_ptr<const wdc::COPTable> table = make_COPTable();
+	ASSERT_TRUE(table != nullptr);
+
+	EXPECT_DOUBLE_EQ(4.0, table->interpolate(0., 35.));  // nodes
+	EXPECT_DOUBLE_EQ(4.4, table->interpolate(15., 45.));
+	EXPECT_DOUBLE_EQ(4.2, table->interpolate(30., 55.));
+	EXPECT_DOUBLE_EQ(4.5, table->interpolate(5., 35.));  // on edges
+	EXPECT_DOUBLE_EQ(3.55, table->interpolate(10., 50.));
+	EXPECT_DOUBLE_EQ(0.25 * (5.6 + 4.4 + 7.0 + 5.5), table->interpolate(22.5, 40.));  // cell center
+	EXPECT_DOUBLE_EQ(table->interpolate(0., 35.), table->interpolate(-20., 20.));  // clamped
+	EXPECT_DOUBLE_EQ(table->interpolate(30., 55.), table->interpolate(40., 90.));
+
+	// scan across all intervals - compare with search for interval
+	const std::vector<double> T_source = { 0., 10., 15., 30. };
+	for(double x=-1.; x<=31.; x+=0.25)
+	{
+		std::size_t interval;
+		double weight;
+		table->get_T_source().locate(x, interval, weight);
+		const double clamped = std::min(std::max(x, 0.), 30.);
+		std::size_t expected = 0;
+		while(expected + 2 < T_source.size() && T_source[expected+1] <= clamped)
+			++expected;
+		EXPECT_EQ(expected, interval) << x;
+		EXPECT_GE(weight, 0.);
+		EXPECT_LE(weight, 1.);
+	}
+}
+
+TEST(HeatPumpTest, table_rejects_invalid_input)
+{
+	EXPECT_TRUE(wdc::COPTable::create({ 0. }, { 35., 45. }, { 4., 3. }) == nullptr);
+	EXPECT_TRUE(wdc::COPTable::create({ 0., 10. }, { 45., 35. }, { 4., 3., 5., 4. }) == nullptr);
+	EXPECT_TRUE(wdc::COPTable::create({ 0., 10. }, { 35., 45. }, { 4., 3., 5. }) == nullptr);
+	EXPECT_TRUE(wdc::COPTable::load("no_such_COPTable.txt") == nullptr);
+}
+
+TEST(HeatPumpTest, table_loaded_from_file)
+{
+	const char* path = "test_COPTable.txt";
+	{
+		std::ofstream stream(path);
+		stream << "# COP over T_source (rows) and T_sink (columns)\n" <<
+			"35. 45. 55.\n" <<
+			"0. 4.0 3.2 2.6\n10. 5.0 4.0 3.1  # comment\n\n15. 5.6 4.4 3.4\n30. 7.0 5.5 4.2\n";
+	}
+	const std::shared_ptr<const wdc::COPTable> loaded = wdc::COPTable::load(path), table = make_COPTable();
+	std::remove(path);
+	ASSERT_TRUE(loaded != nullptr);
+	for(double T_source=-5.; T_source<=35.; T_source+=2.5)
+		for(double T_sink=30.; T_sink<=60.; T_sink+=2.5)
+			EXPECT_EQ(table->interpolate(T_source, T_sink), loaded->interpolate(T_source, T_sink));
+}
+
+TEST(HeatPumpTest, batched_evaluation_equals_scalar)
+{
+	const std::shared_ptr<const wdc::COPTable> table = make_COPTable();
+	const std::size_t n = 200;
+	std::vector<double> T_source(n), T_sink(n), COP(n), COP_sameSink(n), COP_heatPump(n);
+	for(std::size_t i=0; i<n; ++i)
+	{
+		T_source[i] = -5. + 0.2 * i;
+		T_sink[i] = 30. + 0.15 * i;
+	}
+	table->interpolate(T_source.data(), T_sink.data(), COP.data(), n);
+	table->interpolate(T_source.data(), 50., COP_sameSink.data(), n);
+	const wdc::TabulatedHeatPump heatPump(table.get(), 50.);
+	heatPump.calculate_COPs(T_source.data(), COP_heatPump.data(), n);
+	for(std::size_t i=0; i<n; ++i)
+	{
+		EXPECT_EQ(table->interpolate(T_source[i], T_sink[i]), COP[i]);
+		EXPECT_EQ(table->interpolate(T_source[i], 50.), COP_sameSink[i]);
+		EXPECT_EQ(COP_sameSink[i], COP_heatPump[i]);
+		EXPECT_EQ(heatPump.calculate_COP(T_source[i]), COP_heatPump[i]);
+	}
+
+	// not operable
+	const std::shared_ptr<const wdc::COPTable> poorTable =
+			wdc::COPTable::create({ 0., 10. }, { 35., 45. }, { 0.8, 0.5, 1.5, 2. });
+	const wdc::TabulatedHeatPump poor(poorTable.get(), 45.);
+	EXPECT_EQ(-1., poor.calculate_COP(0.));
+	EXPECT_EQ(-1., poor.calculate_COP(2.5));
+	EXPECT_DOUBLE_EQ(1.25, poor.calculate_COP(5.));
+}
+
+TEST(HeatPumpTest, controller_uses_table)
+{
+	const wdc::WellDoubletControl::accuracies_t accuracies = { 0.01, 10., 1.e-6 };
+	const std::shared_ptr<const wdc::COPTable> table = make_COPTable();
+	wdc::WellDoubletControl* wellDoubletControl = wdc::WellDoubletControl::create_wellDoubletControl(1, 10., accuracies);
+	wdc::WellDoubletControlBatch batch(1, 1, 10., accuracies);
+
+	wellDoubletControl->set_heatPump(2, 50., 0.);  // no table - no heat pump
+	EXPECT_EQ(-1., wellDoubletControl->get_heatPumpParameter());
+
+	wellDoubletControl->set_heatPumpTable(table);
+	wellDoubletControl->set_heatPump(2, 50., 0.);
+	batch.set_heatPumpTable(table);
+	batch.set_heatPump(0, 2, 50., 0.);
+	EXPECT_EQ(50., wellDoubletControl->get_heatPumpParameter());
+
+	double T_HE = 12.;
+	const double T_UA = 12.;
+	std::vector<double> Q_H = { -5.e5 }, value_target = { 25. }, value_threshold = { -0.01 };
+	std::vector<double> T_HE_batch = { T_HE }, T_UA_batch = { T_UA }, capacity = { 5.e6 };
+	const wdc::WellDoubletControlBatch::balancing_properties_t properties =
+		{ T_HE_batch.data(), T_UA_batch.data(), capacity.data(), capacity.data() };
+	wellDoubletControl->configure(Q_H[0], value_target[0], value_threshold[0], { T_HE, T_UA, 5.e6, 5.e6 });
+	batch.configure(Q_H.data(), value_target.data(), value_threshold.data(), properties);
+	for(int i=0; i<10; ++i)
+	{
+		wellDoubletControl->evaluate_simulation_result({ T_HE, T_UA, 5.e6, 5.e6 });
+		batch.evaluate_simulation_result(properties);
+		EXPECT_EQ(table->interpolate(T_UA, 50.), wellDoubletControl->get_COP());
+		EXPECT_EQ(wellDoubletControl->get_COP(), batch.get_COP(0));
+		EXPECT_EQ(wellDoubletControl->get_result().Q_H, batch.get_result(0).Q_H);
+	}
+
+	// heat pump follows the table of the controller (it does not own it)
+	wellDoubletControl->set_heatPumpTable(wdc::COPTable::create({ 0., 20. }, { 35., 65. }, { 3., 2., 5., 4. }));
+	EXPECT_EQ(50., wellDoubletControl->get_heatPumpParameter());
+	wellDoubletControl->evaluate_simulation_result({ T_HE, T_UA, 5.e6, 5.e6 });
+	EXPECT_EQ(wellDoubletControl->get_heatPumpTable()->interpolate(T_UA, 50.), wellDoubletControl->get_COP());
+	wellDoubletControl->set_heatPumpTable(nullptr);
+	EXPECT_EQ(-1., wellDoubletControl->get_heatPumpParameter());
+	delete wellDoubletControl;
+}
+
+TEST(HeatPumpTest, variant_dispatches_to_stored_model)
+{
+	wdc::HeatPumpVariant heatPump;
+	EXPECT_EQ(wdc::HeatPumpVariant::none, heatPump.get_type());
+	EXPECT_EQ(-1.e6, heatPump.calculate_heat_source(-1.e6, 20., 10.));
+	EXPECT_EQ(-1., heatPump.get_COP());
+
+	wdc::CarnotHeatPump carnot(70., 0.5);
+	heatPump.set(carnot);
+	EXPECT_EQ(wdc::HeatPumpVariant::carnot, heatPump.get_type());
+	EXPECT_EQ(carnot.calculate_heat_source(-1.e6, 20., 10.), heatPump.calculate_heat_source(-1.e6, 20., 10.));
+	EXPECT_EQ(carnot.get_COP(), heatPump.get_COP());
+	EXPECT_EQ(carnot.get_heat_sink(-5.e5), heatPump.get_heat_sink(-5.e5));
+	EXPECT_EQ(0.5, heatPump.get_parameter());
+
+	const std::shared_ptr<const wdc::COPTable> table = make_COPTable();
+	wdc::TabulatedHeatPump tabulated(table.get(), 50.);
+	heatPump.set(wdc::TabulatedHeatPump(table.get(), 50.));
+	EXPECT_EQ(wdc::HeatPumpVariant::tabulated, heatPump.get_type());
+	EXPECT_EQ(tabulated.calculate_heat_source(-1.e6, 20., 10.), heatPump.calculate_heat_source(-1.e6, 20., 10.));
+	EXPECT_EQ(tabulated.get_COP(), heatPump.get_COP());
+	EXPECT_EQ(1, table.use_count());  // table is not owned by heat pumps
+
+	wdc::HeatPumpVariant copy(heatPump);  // copies point to the same table
+	EXPECT_EQ(table.get(), copy.get_tabulated().get_table());
+	EXPECT_EQ(heatPump.get_COP(), copy.get_COP());
+	EXPECT_EQ(heatPump.get_heat_sink(-5.e5), copy.get_heat_sink(-5.e5));
+	copy.restore(4., -1.e5);
+	EXPECT_EQ(4., copy.get_COP());
+	EXPECT_EQ(-1.e5, copy.get_heat_sink());
+	copy.reset();
+	EXPECT_EQ(-1., copy.get_COP());
+	EXPECT_EQ(50., copy.get_parameter());  // keeps parameters
+
+	heatPump = wdc::HeatPumpVariant();
+	EXPECT_EQ(wdc::HeatPumpVariant::none, heatPump.get_type());
+}
@@ -0,0 +1,63 @@
+#ifndef TEST_HELPERS_H
+#define TEST_HELPERS_H
+
+#include <cmath>
+#include <sstream>
+#include <iostream>
+#include "gtest/gtest.h"
+#include "logger.h"
+#include "fakeSimulator.h"
+
+// shared by the test files (all are included into allTests.cpp)
+
+const double relative_powerrate_error = 1.e-2;
+
+// discards std::cout (WDC_LOG) and switches events off while in scope
+// restored by the destructor - also if an ASSERT returns early
+class QuietOutput
+{
+	std::stringstream discard;
+	std::streambuf* cout_buffer;
+	wdc::log::level_t level;
+public:
+	QuietOutput() : cout_buffer(std::cout.rdbuf(discard.rdbuf())), level(wdc::log::get_level())
+	{ wdc::log::set_level(wdc::log::off); }
+	~QuietOutput()
+	{
+		wdc::log::set_level(level);
+		std::cout.rdbuf(cout_buffer);
+	}
+	QuietOutput(const QuietOutput&) = delete;
+	QuietOutput& operator=(const QuietOutput&) = delete;
+};
+
+// heat exchanger model (one node, temperature driven by Q_H and Q_W) for tests without FakeSimulator
+// time step 100 s, porosity 0.5
+inline double solve_heatExchanger(const double& Q_H, const double& Q_W, const double& T_previous,
+	const double& T_UA, const double& volumetricHeatCapacity = 5.e6)
+{
+	return T_previous + 1.e2 * (fabs(Q_W) * 0.5 * (T_UA - T_previous) + Q_H / volumetricHeatCapacity);
+}
+
+// simulates a scenario with a reference simulator and one with an option switched on
+// results agree within accuracies, the option needs at most ratio * iterations of the reference
+// (ratio below one asserts a reduction)
+inline void expect_same_result_with_fewer_iterations(FakeSimulator& reference, FakeSimulator& modified,
+	const int& scheme, const double& Q_H, const double& value_target, const double& value_threshold,
+	const double& ratio)
+{
+	reference.simulate(scheme, Q_H, value_target, value_threshold);
+	modified.simulate(scheme, Q_H, value_target, value_threshold);
+
+	const wdc::WellDoubletControl::result_t result_reference = reference.get_wellDoubletControl()->get_result();
+	const wdc::WellDoubletControl::result_t result_modified = modified.get_wellDoubletControl()->get_result();
+	const wdc::WellDoubletControl::accuracies_t accuracies = reference.get_wellDoubletControl()->get_accuracies();
+
+	EXPECT_NEAR(result_reference.Q_H, result_modified.Q_H, relative_powerrate_error * fabs(result_reference.Q_H));
+	EXPECT_NEAR(result_reference.Q_W, result_modified.Q_W, accuracies.flowrate*10);
+	EXPECT_NEAR(result_reference.T_HE, result_modified.T_HE, accuracies.temperature*10);
+	EXPECT_EQ(result_reference.storage_state, result_modified.storage_state);
+	EXPECT_LE(modified.get_numberOfIterations(), ratio * reference.get_numberOfIterations());
+}
+
+#endif
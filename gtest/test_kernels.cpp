@@ -0,0 +1,133 @@
+#include <vector>
+#include <cfloat>
+#include "kernels.h"
+#include "advection.h"
+
+// error bound documented in kernels.h
+const double fast_pow_relative_error = 1.e-13;
+
+
+TEST(KernelTest, fast_pow_within_error_bound)
+{
+	for(int i=1; i<=2000; ++i)
+	{
+		const double x = std::pow(i / 2000., 3);  // dense close to zero
+		for(int j=0; j<=40; ++j)
+		{
+			const double y = j / 20.;
+			const double expected = std::pow(x, y);
+			EXPECT_NEAR(expected, wdc::simd::fast_pow(x, y),
+				fast_pow_relative_error * expected + 2.3e-308) << "x: " << x << " y: " << y;
+		}
+	}
+}
+
+TEST(KernelTest, threshold_factor_and_confined_for_all_instruction_sets)
+{
+	const std::size_t n = 1003;  // not a multiple of the vector widths
+	std::vector<double> value(n), threshold(n), sigma(n), lower(n), upper(n);
+	for(std::size_t i=0; i<n; ++i)
+	{
+		value[i] = 30. + 40. * i / n;
+		threshold[i] = (i % 3 == 0) ? 40. : 60.;
+		sigma[i] = (i % 2 == 0) ? 1. : -1.;
+		lower[i] = (i % 2 == 0) ? 35. : -1.e-6;
+		upper[i] = (i % 2 == 0) ? 65. : 50.;
+	}
+
+	std::vector<double> factor(n), confined(n);
+	const wdc::simd::isa_t isas[] = { wdc::simd::scalar, wdc::simd::avx2, wdc::simd::avx512 };
+	for(const wdc::simd::isa_t& isa : isas)
+	{
+		if(!wdc::simd::is_supported(isa))
+			continue;
+		SCOPED_TRACE(wdc::simd::get_name(isa));
+
+		wdc::simd::make_threshold_factor(value.data(), threshold.data(), sigma.data(), 10., factor.data(), n, isa);
+		wdc::simd::make_confined(value.data(), lower.data(), upper.data(), confined.data(), n, isa);
+		for(std::size_t i=0; i<n; ++i)
+		{
+			const double expected = wdc::make_threshold_factor(value[i], threshold[i], 10.,
+					(sigma[i] > 0.) ? wdc::lower : wdc::upper);
+			if(isa == wdc::simd::scalar)
+				EXPECT_EQ(expected, factor[i]);
+			else
+				EXPECT_NEAR(expected, factor[i], fast_pow_relative_error * expected + 2.3e-308);
+			EXPECT_EQ(wdc::make_confined(value[i], lower[i], upper[i]), confined[i]);
+		}
+
+		wdc::simd::make_threshold_factor(value.data(), threshold.data(), sigma.data(), 0., factor.data(), n, isa);
+		for(std::size_t i=0; i<n; ++i)
+			EXPECT_EQ(1., factor[i]);
+	}
+}
+
+TEST(KernelTest, advect_identical_for_all_instruction_sets)
+{
+	const std::size_t n = 1003;
+	std::vector<double> previous(n), reference(n), expected(n), temperatures(n);
+	for(std::size_t i=0; i<n; ++i)
+	{
+		previous[i] = 50. - 40. * std::exp(-0.01 * i);
+		reference[i] = previous[i] + ((i == 517) ? 0.3 : 0.001 * (i % 7));
+	}
+
+	const double expected_error = advect(previous.data(), reference.data(), expected.data(), 0.5, 1, n,
+			wdc::simd::scalar);
+	double error = 0.;
+	for(std::size_t i=1; i<n; ++i)
+	{
+		EXPECT_EQ(previous[i] + 0.5 * (previous[i-1] - previous[i]), expected[i]);
+		error = std::max(error, std::fabs(expected[i] - reference[i]));
+	}
+	EXPECT_EQ(error, expected_error);
+
+	const wdc::simd::isa_t isas[] = { wdc::simd::avx2, wdc::simd::avx512 };
+	for(const wdc::simd::isa_t& isa : isas)
+	{
+		if(!wdc::simd::is_supported(isa))
+			continue;
+		SCOPED_TRACE(wdc::simd::get_name(isa));
+		for(std::size_t begin : { std::size_t(1), std::size_t(6), std::size_t(998) })  // unaligned starts and tails
+		{
+			std::fill(temperatures.begin(), temperatures.end(), 0.);
+			double error_begin = 0.;
+			for(std::size_t i=begin; i<n; ++i)
+				error_begin = std::max(error_begin, std::fabs(expected[i] - reference[i]));
+			EXPECT_EQ(error_begin, advect(previous.data(), reference.data(), temperatures.data(), 0.5, begin, n, isa));
+			for(std::size_t i=begin; i<n; ++i)
+				EXPECT_EQ(expected[i], temperatures[i]);
+		}
+	}
+}
+
+TEST(KernelTest, advect_implicit_solves_tridiagonal_system)
+{
+	const std::size_t n = 50, source_node = 5;
+	const double courant = 20., source = 3.;  // far beyond explicit stability
+	std::vector<double> previous(n), reference(n, 0.), temperatures(n), scratch(n);
+	for(std::size_t i=0; i<n; ++i)
+		previous[i] = 10. + (i % 5);
+
+	for(const double& diffusion : { 0., 7.5 })
+	{
+		SCOPED_TRACE(diffusion);
+		const double error = advect_implicit(previous.data(), reference.data(), temperatures.data(), scratch.data(),
+				courant, diffusion, source_node, source, n);
+		EXPECT_EQ(previous[0], temperatures[0]);
+		double max = 0.;
+		for(std::size_t i=1; i<n; ++i)
+		{	// residual of row i
+			const double upper = (i+1 < n) ? temperatures[i+1] : temperatures[i];  // zero gradient at outlet
+			const double residual = -(courant + diffusion) * temperatures[i-1] +
+				(1. + courant + 2.*diffusion) * temperatures[i] - diffusion * upper -
+				previous[i] - ((i == source_node) ? source : 0.);
+			EXPECT_NEAR(0., residual, 1.e-12 * (1. + courant + 2.*diffusion) * 20.);
+			// no over- and undershoots (M-matrix)
+			EXPECT_GE(temperatures[i], 10. - 1.e-12);
+			EXPECT_LE(temperatures[i], 14. + source);
+			max = std::max(max, std::fabs(temperatures[i]));
+		}
+		EXPECT_EQ(std::max(max, previous[0]), error);
+	}
+}
@@ -0,0 +1,53 @@
+#include <fstream>
+#include <cstdio>
+#include "logSink.h"
+
+
+TEST(LogSinkTest, lines_with_time_offset_written_at_close)
+{
+	const char* path = "test_logSink.txt";
+	std::remove(path);
+
+	LogSink logSink;
+	logSink.open(path);
+	logSink.write("Time step: 0");
+	logSink.write(42);
+	logSink.close();
+	logSink.write("not written");  // closed
+
+	std::ifstream stream(path);
+	std::string header, first, second, end;
+	std::getline(stream, header);
+	std::getline(stream, first);
+	std::getline(stream, second);
+	EXPECT_FALSE(std::getline(stream, end));
+
+	EXPECT_NE(std::string::npos, header.find("log opened"));
+	EXPECT_EQ('+', first[0]);
+	EXPECT_EQ("s: Time step: 0", first.substr(first.find('s')));
+	EXPECT_EQ("s: 42", second.substr(second.find('s')));
+	std::remove(path);
+}
+
+TEST(LogSinkTest, buffer_is_allocated_only_while_open)
+{
+	EXPECT_LT(sizeof(LogSink), std::size_t(4096));  // simulators on the stack
+
+	const char* path = "test_logSink.txt";
+	std::remove(path);
+	LogSink logSink;
+	for(int i=0; i<2; ++i)
+	{	// reopened with a new buffer
+		logSink.open(path);
+		logSink.write(i);
+		logSink.close();
+	}
+
+	std::ifstream stream(path);
+	std::string line;
+	int lines = 0;
+	while(std::getline(stream, line))
+		++lines;
+	EXPECT_EQ(4, lines);  // header and line per opening
+	std::remove(path);
+}
@@ -0,0 +1,159 @@
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include "logger.h"
+#include "ringBuffer.h"
+
+
+TEST(RingBufferTest, push_pop_until_full)
+{
+	wdc::RingBuffer<int> buffer(5);  // rounded to 8
+	EXPECT_EQ(8u, buffer.capacity());
+	for(int i=0; i<8; ++i)
+		EXPECT_TRUE(buffer.push(i));
+	EXPECT_FALSE(buffer.push(8));
+
+	int value;
+	for(int i=0; i<8; ++i)
+	{
+		EXPECT_TRUE(buffer.pop(value));
+		EXPECT_EQ(i, value);
+	}
+	EXPECT_FALSE(buffer.pop(value));
+}
+
+class LoggerTest : public ::testing::Test
+{
+protected:
+	std::stringstream stream;
+	wdc::log::level_t level;
+	int categories;
+
+	void SetUp() override
+	{
+		wdc::log::flush();
+		level = wdc::log::get_level();
+		categories = wdc::log::get_categories();
+		wdc::log::set_sink(&stream);
+	}
+	void TearDown() override
+	{
+		wdc::log::set_sink(&std::cout);
+		wdc::log::set_level(level);
+		wdc::log::set_categories(categories);
+	}
+};
+
+TEST_F(LoggerTest, events_are_formatted_at_flush)
+{
+	wdc::log::set_level(wdc::log::debug);
+	wdc::log::set_categories(wdc::log::all);
+
+	WDC_EVENT(set_flowrate, 0.01);
+	WDC_EVENT_TEXT(configure_scheme, "storing", 1.);
+	EXPECT_EQ("", stream.str());
+
+	wdc::log::flush();
+	EXPECT_EQ("\t\t\tset flow rate\t0.01\n\t\t\tconfigure scheme 1\n\t\t\t\tfor storing\n", stream.str());
+}
+
+TEST_F(LoggerTest, filter_by_level_and_category)
+{
+	wdc::log::set_level(wdc::log::info);
+	wdc::log::set_categories(wdc::log::controller | wdc::log::powerrate);
+	EXPECT_FALSE(wdc::log::is_enabled(wdc::log::set_flowrate));  // debug
+	EXPECT_FALSE(wdc::log::is_enabled(wdc::log::stop_adapting_flowrate));  // category flowrate
+	EXPECT_TRUE(wdc::log::is_enabled(wdc::log::switch_off_well));
+
+	WDC_EVENT(set_flowrate, 0.01);
+	WDC_EVENT(stop_adapting_flowrate);
+	WDC_EVENT(switch_off_well);
+	wdc::log::flush();
+	EXPECT_EQ("\t\t\tswitch off well\n", stream.str());
+
+	wdc::log::set_level(wdc::log::off);
+	EXPECT_FALSE(wdc::log::is_enabled(wdc::log::switch_off_well));
+}
+
+TEST_F(LoggerTest, flush_does_nothing_if_level_is_off)
+{
+	wdc::log::set_level(wdc::log::debug);
+	wdc::log::set_categories(wdc::log::all);
+	WDC_EVENT(set_flowrate, 0.01);
+
+	wdc::log::set_level(wdc::log::off);
+	wdc::log::flush();
+	EXPECT_EQ("", stream.str());  // kept in buffer
+
+	wdc::log::set_level(wdc::log::debug);
+	wdc::log::flush();
+	EXPECT_EQ("\t\t\tset flow rate\t0.01\n", stream.str());
+	wdc::log::flush();  // nothing recorded since
+	EXPECT_EQ("\t\t\tset flow rate\t0.01\n", stream.str());
+}
+
+TEST_F(LoggerTest, flush_concurrent_with_recording_misses_no_event)
+{
+	wdc::log::set_level(wdc::log::debug);
+	wdc::log::set_categories(wdc::log::all);
+
+	const int n = 1000;  // per round - below buffer capacity
+	for(int round=0; round<100; ++round)
+	{
+		std::atomic<bool> done(false);
+		std::thread producer([&done]()
+		{
+			for(double i=0; i<n; ++i)
+				WDC_EVENT(set_flowrate, i);
+			done = true;
+		});
+		while(!done)
+			wdc::log::flush();
+		producer.join();
+		wdc::log::flush();  // returns at once if flag is cleared - last events must be written anyway
+
+		int lines = 0;
+		std::string line;
+		while(std::getline(stream, line))
+			++lines;
+		ASSERT_EQ(n, lines) << "round " << round;
+		stream.str("");
+		stream.clear();
+	}
+}
+
+TEST_F(LoggerTest, stop_writes_events_without_background_thread)
+{
+	wdc::log::set_level(wdc::log::debug);
+	wdc::log::set_categories(wdc::log::all);
+	WDC_EVENT(set_flowrate, 0.5);
+	wdc::log::stop();  // as at exit
+	EXPECT_EQ("\t\t\tset flow rate\t0.5\n", stream.str());
+}
+
+TEST_F(LoggerTest, events_of_threads_in_order_with_background_flush)
+{
+	wdc::log::set_level(wdc::log::debug);
+	wdc::log::set_categories(wdc::log::all);
+	wdc::log::start(1);
+
+	const int n = 1000;
+	std::thread first([]() { for(double i=0; i<n; ++i) WDC_EVENT(set_flowrate, i); });
+	std::thread second([]() { for(double i=0; i<n; ++i) WDC_EVENT(operability, i); });
+	first.join();
+	second.join();
+	wdc::log::stop();
+
+	std::string line;
+	int lines = 0, flowrate_expected = 0, operability_expected = 0;
+	while(std::getline(stream, line))
+	{
+		++lines;
+		if(line.find("set flow rate") != std::string::npos)
+			EXPECT_EQ(flowrate_expected++, std::stoi(line.substr(line.rfind('\t'))));
+		else
+			EXPECT_EQ(operability_expected++, std::stoi(line.substr(line.find(':') + 1)));
+	}
+	EXPECT_EQ(2*n, lines);
+	EXPECT_EQ(0u, wdc::log::get_numberOfDroppedEvents());
+}
@@ -0,0 +1,56 @@
+#include <sstream>
+#include "fakeSimulator.h"
+#include "statistics.h"
+
+
+TEST(StatisticsTest, counters_match_simulation)
+{
+	FakeSimulator simulator;
+	simulator.set_statistics_enabled(true);
+	simulator.simulate(1, 2.e6, 100., 0.01);  // flowrate adaption and then powerrate adaption
+
+	const wdc::statistics_t& statistics = simulator.get_wellDoubletControl()->get_statistics();
+	EXPECT_EQ(c_numberOfTimeSteps, statistics.timeSteps);
+	EXPECT_EQ(simulator.get_numberOfIterations(), statistics.iterations);
+	EXPECT_LE(statistics.iterations_timeStep_max, c_maxNumberOfIterations);
+
+	long iterations_state = 0;
+	for(int i=0; i<wdc::statistics_t::numberOfStates; ++i)
+		iterations_state += statistics.iterations_state[i];
+	EXPECT_EQ(statistics.iterations, iterations_state);
+
+	EXPECT_GT(statistics.transitions[wdc::WellDoubletControl::on_demand]
+					[wdc::WellDoubletControl::powerrate_to_adapt], 0);
+	EXPECT_GT(statistics.flowrate_adaptions, 0);
+	EXPECT_GT(statistics.powerrate_adaptions, 0);
+	EXPECT_GT(statistics.flowrate_not_converged + statistics.powerrate_not_converged, 0);
+}
+
+TEST(StatisticsTest, disabled_by_default)
+{
+	FakeSimulator simulator;
+	simulator.simulate(1, 2.e6, 100., 0.01);
+	EXPECT_EQ(0, simulator.get_wellDoubletControl()->get_statistics().iterations);
+}
+
+TEST(StatisticsTest, aggregate_over_doublets)
+{
+	std::vector<wdc::statistics_t> statistics(3);
+	statistics[0].iterations = 5;
+	statistics[1].iterations = 50;
+	statistics[2].iterations = 20;
+	statistics[1].iterations_timeStep_max = 7;
+
+	wdc::statistics_t sum;
+	for(const wdc::statistics_t& doublet : statistics)
+		sum += doublet;
+	EXPECT_EQ(75, sum.iterations);
+	EXPECT_EQ(7, sum.iterations_timeStep_max);
+
+	std::stringstream stream;
+	wdc::write_statistics(stream, statistics, 2);
+	const std::string output = stream.str();
+	EXPECT_NE(std::string::npos, output.find("doublets: 3"));
+	EXPECT_LT(output.find("doublet 1 "), output.find("doublet 2 "));  // sorted by iterations
+	EXPECT_EQ(std::string::npos, output.find("doublet 0 "));  // not in top 2
+}
@@ -0,0 +1,71 @@
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include "threadPool.h"
+#include "fakeSimulator.h"
+
+
+TEST(ThreadPoolTest, parallel_for_calls_each_index_once)
+{
+	ThreadPool pool(4);
+	std::vector<std::atomic<int>> calls(1000);
+	for(std::atomic<int>& call : calls)
+		call = 0;
+	pool.parallel_for(calls.size(), [&](const std::size_t& i) { ++calls[i]; });
+	for(std::size_t i=0; i<calls.size(); ++i)
+		EXPECT_EQ(1, calls[i]);
+
+	pool.parallel_for(0, [&](const std::size_t& i) { ++calls[i]; });  // nothing to do
+	EXPECT_EQ(1, calls[0]);
+}
+
+TEST(ThreadPoolTest, idle_workers_steal_from_busy_queue)
+{
+	ThreadPool pool(4);
+	std::atomic<int> done(0);
+	// every 4th task is slow - queues of the other workers run empty first
+	pool.parallel_for(64, [&](const std::size_t& i)
+	{
+		if(i % 4 == 0)
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		++done;
+	});
+	EXPECT_EQ(64, done);
+	EXPECT_GT(pool.get_numberOfStolenTasks(), 0);
+}
+
+TEST(ThreadPoolTest, parallel_simulations_match_serial)
+{
+	const double cases[][4] = { { 0, 1.e6, 0.01, 80. }, { 1, 1.e6, 100., 0.01 },
+		{ 1, -5.e5, 25., -0.01 }, { 2, 2.e6, 450.e6, 0.01 } };
+	const std::size_t n = sizeof(cases) / sizeof(cases[0]);
+
+	QuietOutput quiet;  // WDC_LOG of simulators
+
+	std::vector<wdc::WellDoubletControl::result_t> serial(n), parallel(n);
+	std::vector<int> iterations_serial(n), iterations_parallel(n);
+	auto run = [&](const std::size_t& i, std::vector<wdc::WellDoubletControl::result_t>& results,
+			std::vector<int>& iterations)
+	{
+		FakeSimulator simulator;
+		simulator.set_logFile("");
+		simulator.simulate(static_cast<int>(cases[i][0]), cases[i][1], cases[i][2], cases[i][3]);
+		results[i] = simulator.get_wellDoubletControl()->get_result();
+		iterations[i] = simulator.get_numberOfIterations();
+	};
+	for(std::size_t i=0; i<n; ++i)
+		run(i, serial, iterations_serial);
+	{
+		ThreadPool pool(4);
+		pool.parallel_for(n, [&](const std::size_t& i) { run(i, parallel, iterations_parallel); });
+	}
+
+	for(std::size_t i=0; i<n; ++i)
+	{
+		EXPECT_EQ(serial[i].Q_H, parallel[i].Q_H);
+		EXPECT_EQ(serial[i].Q_W, parallel[i].Q_W);
+		EXPECT_EQ(serial[i].T_HE, parallel[i].T_HE);
+		EXPECT_EQ(serial[i].storage_state, parallel[i].storage_state);
+		EXPECT_EQ(iterations_serial[i], iterations_parallel[i]);
+	}
+}
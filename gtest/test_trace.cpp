@@ -0,0 +1,46 @@
+#include <fstream>
+#include <cstdio>
+#include "trace.h"
+#include "fakeSimulator.h"
+
+
+TEST(TraceTest, replay_reproduces_recorded_simulations)
+{
+	const char* path = "test_trace.bin";
+	QuietOutput quiet;  // WDC_LOG of simulators
+
+	int numberOfIterations = 0;
+	{
+		FakeSimulator simulator;
+		simulator.set_logFile("");
+		ASSERT_TRUE(simulator.set_traceFile(path));
+		simulator.simulate(0, 1.e6, 0.01, 80.);
+		numberOfIterations += simulator.get_numberOfIterations();
+		simulator.set_heatPump(1, 70., 0.5);
+		simulator.set_warmStart(true);
+		simulator.set_flowrate_adaption(wdc::WellDoubletControl::secant);
+		simulator.set_powerrate_adaption(wdc::WellDoubletControl::newton);
+		simulator.simulate(1, -5.e5, 25., -0.01);  // scheme changes - same id
+		numberOfIterations += simulator.get_numberOfIterations();
+		simulator.simulate(2, 2.e6, 450.e6, 0.01);
+		numberOfIterations += simulator.get_numberOfIterations();
+	}  // trace written
+
+	wdc::TraceReplay replay;
+	ASSERT_TRUE(replay.load(path));
+
+	EXPECT_EQ(1u, replay.get_numberOfControllers());
+	EXPECT_EQ(std::size_t(numberOfIterations), replay.get_numberOfEvaluations());
+	EXPECT_EQ(0u, replay.run());
+	EXPECT_EQ(0u, replay.run());  // deterministic - states are restored from trace
+
+	// a changed result is found
+	std::ifstream stream(path, std::ios::binary);
+	std::string trace((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+	const std::size_t last_Q_W = trace.size() - sizeof(wdc::trace_result_t) + sizeof(double);
+	trace[last_Q_W + 7] ^= 0x10;
+	ASSERT_TRUE(replay.assign(trace.data(), trace.size()));
+	EXPECT_EQ(1u, replay.run());
+	EXPECT_FALSE(replay.assign(trace.data(), trace.size() - 1));  // truncated
+	std::remove(path);
+}
@@ -0,0 +1,26 @@
+#include "fakeSimulator.h"
+#include "wellDoubletControl.h"
+
+class WarmStartTest : public ::testing::TestWithParam<std::tuple<
+	char, double, double, double, double> > {};
+
+
+TEST_P(WarmStartTest, same_result_with_fewer_iterations)
+{
+	FakeSimulator cold, warm;
+	warm.set_warmStart(true);
+	expect_same_result_with_fewer_iterations(cold, warm, std::get<0>(GetParam()), std::get<1>(GetParam()),
+		std::get<2>(GetParam()), std::get<3>(GetParam()), std::get<4>(GetParam()));
+}
+
+
+INSTANTIATE_TEST_CASE_P(SCHEMES, WarmStartTest, testing::Values(
+	// input: scheme, Q_H, value_target, value_threshold, maximum ratio of iteration numbers
+	// (scheme 0 converges in the minimum number of iterations)
+	std::make_tuple(0, 1.e6, 0.01, 80., 1.),
+	std::make_tuple(0, -1.e6, -0.01, 30., 1.),
+	std::make_tuple(1, 1.e6, 100., 0.01, .5),  // 748 -> 325
+	std::make_tuple(1, 2.e6, 100., 0.01, .75),  // 243 -> 171
+	std::make_tuple(1, -5.e5, 25., -0.01, .5),  // 360 -> 165
+	std::make_tuple(1, -1.e6, 25., -0.01, .9)  // 115 -> 99
+));
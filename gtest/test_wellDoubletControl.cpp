@@ -1,8 +1,6 @@
 #include "fakeSimulator.h"
 #include "wellDoubletControl.h"
 
-const double relative_powerrate_error = 1.e-2;
-
 class WellDoubletTest : public ::testing::TestWithParam<std::tuple<
 	char, double, double, double, double, double, double, wdc::WellDoubletControl::storage_state_t> > {};
 
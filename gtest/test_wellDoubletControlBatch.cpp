@@ -0,0 +1,77 @@
+#include <vector>
+#include "wellDoubletControlBatch.h"
+
+// compares batch controller with the scalar controllers in a simple
+// heat exchanger model (solve_heatExchanger)
+TEST(WellDoubletControlBatchTest, identical_to_scalar_schemes)
+{
+	const wdc::WellDoubletControl::accuracies_t accuracies = { 0.01, 10., 1.e-6 };
+	struct scenario_t { double Q_H, value_target, value_threshold; int heatPump_type; };
+	const std::vector<std::vector<scenario_t> > scenarios = {
+		// scheme 0
+		{ {1.e6, 0.01, 100., 0}, {1.e6, 0.01, 80., 0}, {-1.e5, -0.01, 30., 0}, {-1.e6, -0.01, 30., 1} },
+		// scheme 1
+		{ {1.e5, 100., 0.01, 0}, {1.e6, 100., 0.01, 0}, {2.e6, 100., 0.01, 0},
+			{-1.e5, 25., -0.01, 0}, {-5.e5, 25., -0.01, 1}, {-1.e6, 25., -0.01, 0} },
+		// scheme 2
+		{ {1.e6, 450.e6, 0.01, 0}, {2.e6, 450.e6, 0.01, 0}, {-5.e5, -125.e6, -0.01, 1}, {-1.e6, -125.e6, -0.01, 0} }
+	};
+
+	for(int scheme=0; scheme<3; ++scheme)
+	{
+		const std::vector<scenario_t>& s = scenarios[scheme];
+		const std::size_t n = s.size();
+
+		wdc::WellDoubletControlBatch batch(scheme, n, 10., accuracies);
+		std::vector<wdc::WellDoubletControl*> scalar(n);
+		std::vector<double> Q_H(n), value_target(n), value_threshold(n);
+		std::vector<double> T_HE(n, 50.), T_UA(n), capacity(n, 5.e6), T_HE_step(n, 50.);
+		for(std::size_t i=0; i<n; ++i)
+		{
+			scalar[i] = wdc::WellDoubletControl::create_wellDoubletControl(scheme, 10., accuracies);
+			scalar[i]->set_heatPump(s[i].heatPump_type, 70., 0.5);
+			batch.set_heatPump(i, s[i].heatPump_type, 70., 0.5);
+			Q_H[i] = s[i].Q_H;
+			value_target[i] = s[i].value_target;
+			value_threshold[i] = s[i].value_threshold;
+			T_UA[i] = (s[i].Q_H > 0.) ? 10. : 50.;
+		}
+		const wdc::WellDoubletControlBatch::balancing_properties_t properties =
+			{ T_HE.data(), T_UA.data(), capacity.data(), capacity.data() };
+
+		for(int timeStep=0; timeStep<5; ++timeStep)
+		{
+			batch.configure(Q_H.data(), value_target.data(), value_threshold.data(), properties);
+			for(std::size_t i=0; i<n; ++i)
+				scalar[i]->configure(Q_H[i], value_target[i], value_threshold[i],
+					{ T_HE[i], T_UA[i], capacity[i], capacity[i] });
+
+			for(int iteration=0; iteration<20; ++iteration)
+			{
+				for(std::size_t i=0; i<n; ++i)
+				{
+					const wdc::WellDoubletControl::result_t result = scalar[i]->get_result();
+					T_HE[i] = solve_heatExchanger(result.Q_H, result.Q_W, T_HE_step[i], T_UA[i], capacity[i]);
+				}
+				batch.evaluate_simulation_result(properties);
+				for(std::size_t i=0; i<n; ++i)
+				{
+					scalar[i]->evaluate_simulation_result({ T_HE[i], T_UA[i], capacity[i], capacity[i] });
+
+					const wdc::WellDoubletControl::result_t expected = scalar[i]->get_result();
+					const wdc::WellDoubletControl::result_t result = batch.get_result(i);
+					EXPECT_EQ(expected.Q_H, result.Q_H);
+					EXPECT_EQ(expected.Q_W, result.Q_W);
+					EXPECT_EQ(expected.Q_H_sys, result.Q_H_sys);
+					EXPECT_EQ(expected.storage_state, result.storage_state);
+					EXPECT_EQ(scalar[i]->get_COP(), batch.get_COP(i));
+					EXPECT_EQ(scalar[i]->converged(), batch.converged(i));
+				}
+			}
+			T_HE_step = T_HE;
+		}
+
+		for(std::size_t i=0; i<n; ++i)
+			delete scalar[i];
+	}
+}
@@ -0,0 +1,103 @@
+#include <vector>
+#include <algorithm>
+#include "wellIndex.h"
+
+// deterministic scattered mesh nodes (unstructured mesh) and wells
+static double next_random(unsigned long& state)
+{
+	state = state * 6364136223846793005ul + 1442695040888963407ul;
+	return (state >> 11) * (1. / 9007199254740992.);
+}
+
+static std::size_t nearest_bruteForce(const std::vector<wdc::WellIndex::point_t>& nodes,
+	const wdc::WellIndex::point_t& point)
+{
+	std::size_t best = 0;
+	double best_distance = 1.e300;
+	for(std::size_t j=0; j<nodes.size(); ++j)
+	{
+		const double dx = nodes[j].x - point.x, dy = nodes[j].y - point.y;
+		if(dx * dx + dy * dy < best_distance)
+		{
+			best_distance = dx * dx + dy * dy;
+			best = j;
+		}
+	}
+	return best;
+}
+
+
+TEST(WellIndexTest, nodes_and_neighbours_as_brute_force)
+{
+	unsigned long state = 42;
+	std::vector<wdc::WellIndex::point_t> nodes(5000), warm(200), cold(200);
+	for(wdc::WellIndex::point_t& node : nodes)
+		node = { 1000. * next_random(state), 500. * next_random(state) };
+	for(std::size_t i=0; i<warm.size(); ++i)
+	{
+		warm[i] = { 1100. * next_random(state) - 50., 550. * next_random(state) - 25. };  // some outside the mesh
+		cold[i] = { warm[i].x + 40. * next_random(state), warm[i].y + 40. * next_random(state) };
+	}
+
+	wdc::WellIndex index;
+	EXPECT_FALSE(index.build(nodes.data(), 0, warm.data(), cold.data(), warm.size()));
+	ASSERT_TRUE(index.build(nodes.data(), nodes.size(), warm.data(), cold.data(), warm.size()));
+	ASSERT_EQ(warm.size(), index.get_numberOfDoublets());
+	for(std::size_t i=0; i<warm.size(); ++i)
+	{
+		EXPECT_EQ(nearest_bruteForce(nodes, warm[i]), index.get_warmNode(i));
+		EXPECT_EQ(nearest_bruteForce(nodes, cold[i]), index.get_coldNode(i));
+	}
+
+	std::vector<std::size_t> neighbours, expected;
+	for(const double radius : { 0., 30., 100. })
+		for(std::size_t i=0; i<warm.size(); ++i)
+		{
+			index.find_neighbours(i, radius, neighbours);
+			expected.clear();
+			for(std::size_t j=0; j<warm.size(); ++j)
+			{
+				if(j == i)
+					continue;
+				for(const wdc::WellIndex::point_t& a : { warm[i], cold[i] })
+					for(const wdc::WellIndex::point_t& b : { warm[j], cold[j] })
+						if((a.x-b.x) * (a.x-b.x) + (a.y-b.y) * (a.y-b.y) <= radius * radius)
+							expected.push_back(j);
+			}
+			expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+			EXPECT_EQ(expected, neighbours) << i << " " << radius;
+		}
+}
+
+TEST(WellIndexTest, gathers_balancing_temperatures)
+{
+	// structured 10 x 10 mesh, temperature is node index
+	std::vector<wdc::WellIndex::point_t> nodes;
+	std::vector<double> temperatures;
+	for(int y=0; y<10; ++y)
+		for(int x=0; x<10; ++x)
+		{
+			nodes.push_back({ double(x), double(y) });
+			temperatures.push_back(nodes.size() - 1);
+		}
+	const std::vector<wdc::WellIndex::point_t> warm = { { 1.1, 1.2 }, { 7.9, 3. } }, cold = { { 4., 1. }, { 8.2, 7.6 } };
+	wdc::WellIndex index;
+	ASSERT_TRUE(index.build(nodes.data(), nodes.size(), warm.data(), cold.data(), 2));
+	EXPECT_EQ(11u, index.get_warmNode(0));
+	EXPECT_EQ(14u, index.get_coldNode(0));
+	EXPECT_EQ(38u, index.get_warmNode(1));
+	EXPECT_EQ(88u, index.get_coldNode(1));
+
+	const std::vector<double> Q_H = { 1.e6, -5.e5 };
+	std::vector<double> T_HE(2), T_UA(2), T_warm(2), T_cold(2);
+	index.gather(temperatures.data(), Q_H.data(), T_HE.data(), T_UA.data());
+	index.gather_wells(temperatures.data(), T_warm.data(), T_cold.data());
+	EXPECT_EQ(std::vector<double>({ 11., 88. }), T_HE);  // injection wells
+	EXPECT_EQ(std::vector<double>({ 14., 38. }), T_UA);
+	EXPECT_EQ(std::vector<double>({ 11., 38. }), T_warm);
+	EXPECT_EQ(std::vector<double>({ 14., 88. }), T_cold);
+
+	// single node
+	ASSERT_TRUE(index.build(nodes.data(), 1, warm.data(), cold.data(), 2));
+	EXPECT_EQ(0u, index.get_coldNode(1));
+}
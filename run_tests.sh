@@ -1,11 +1,9 @@
 
 cd build
-rm timer.txt
 cmake -Dlogging=$1 ..
 make
 ./run_tests
+./run_allocationTests
 
-cat timer.txt
+./benchmark/wdc_bench --macro --json bench.json
 cd ..
-
-
@@ -0,0 +1,348 @@
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include <type_traits>
+#include "checkpoint.h"
+
+namespace wdc
+{
+
+static_assert(std::is_trivially_copyable<checkpoint_t>::value, "checkpoint_t is written as is");
+static_assert(sizeof(checkpoint_t) == 32 * sizeof(double) + 6 * 4 + 8, "checkpoint_t has padding");
+static_assert(sizeof(checkpoint_header_t) % alignof(checkpoint_t) == 0, "records are not aligned");
+
+namespace
+{
+
+const char c_magic[4] = { 'W', 'D', 'C', 'C' };
+const std::uint32_t c_byteOrder = 0x01020304;
+
+checkpoint_t* write_header(void* buffer, const std::size_t& n)
+{
+	checkpoint_header_t header;
+	std::memcpy(header.magic, c_magic, sizeof(c_magic));
+	header.version = c_checkpointVersion;
+	header.recordSize = sizeof(checkpoint_t);
+	header.byteOrder = c_byteOrder;
+	header.numberOfRecords = n;
+	std::memcpy(buffer, &header, sizeof(header));
+	return reinterpret_cast<checkpoint_t*>(static_cast<char*>(buffer) + sizeof(header));
+}
+
+bool is_valid(const checkpoint_t& checkpoint)
+{	// enums are cast when restored
+	return checkpoint.scheme_ID >= 0 && checkpoint.scheme_ID <= 2 &&
+		checkpoint.storage_state >= WellDoubletControl::powerrate_to_adapt &&
+		checkpoint.storage_state <= WellDoubletControl::rates_reduced &&
+		(checkpoint.operationType == 0 || checkpoint.operationType == 1) &&
+		checkpoint.heatPump_type >= HeatPumpVariant::none && checkpoint.heatPump_type <= HeatPumpVariant::tabulated &&
+		(checkpoint.flowrate_adaption == WellDoubletControl::fixed_point ||
+			checkpoint.flowrate_adaption == WellDoubletControl::secant) &&
+		(checkpoint.powerrate_adaption == WellDoubletControl::fixed_gain ||
+			checkpoint.powerrate_adaption == WellDoubletControl::newton);
+}
+
+bool are_valid(const checkpoint_t* records, const std::size_t& n)
+{
+	for(std::size_t i=0; i<n; ++i)
+		if(!is_valid(records[i]))
+			return false;
+	return true;
+}
+
+bool write_file(const std::string& path, const std::vector<char>& buffer)
+{
+	std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+	stream.write(buffer.data(), buffer.size());
+	return static_cast<bool>(stream);
+}
+
+bool read_file(const std::string& path, std::vector<char>& buffer)
+{
+	std::ifstream stream(path, std::ios::binary | std::ios::ate);
+	if(!stream)
+		return false;
+	buffer.resize(static_cast<std::size_t>(stream.tellg()));
+	stream.seekg(0);
+	stream.read(buffer.data(), buffer.size());
+	return static_cast<bool>(stream);
+}
+
+}  // end anonymous namespace
+
+
+void WellDoubletControl::save_state(checkpoint_t& checkpoint) const
+{
+	std::memset(&checkpoint, 0, sizeof(checkpoint));
+	checkpoint.Q_H = result.Q_H;
+	checkpoint.Q_W = result.Q_W;
+	checkpoint.Q_H_sys = result.Q_H_sys;
+	checkpoint.T_HE = result.T_HE;
+	checkpoint.T_UA = result.T_UA;
+	checkpoint.Q_H_sys_target = Q_H_sys_target;
+	checkpoint.Q_H_sys_old = Q_H_sys_old;
+	checkpoint.Q_W_old = Q_W_old;
+	checkpoint.volumetricHeatCapacity_HE = volumetricHeatCapacity_HE;
+	checkpoint.volumetricHeatCapacity_UA = volumetricHeatCapacity_UA;
+	checkpoint.value_target = value_target;
+	checkpoint.value_threshold = value_threshold;
+	checkpoint.flowrate_adaption_factor = flowrate_adaption_factor;
+	checkpoint.deltaTsign_stored = deltaTsign_stored;
+	checkpoint.well_shutdown_temperature_range = well_shutdown_temperature_range;
+	checkpoint.accuracy_temperature = accuracies.temperature;
+	checkpoint.accuracy_powerrate = accuracies.powerrate;
+	checkpoint.accuracy_flowrate = accuracies.flowrate;
+
+	checkpoint.heatPump_type = heatPump.get_type();
+	if(checkpoint.heatPump_type == HeatPumpVariant::carnot)
+	{
+		checkpoint.heatPump_T_sink = heatPump.get_carnot().get_T_sink();
+		checkpoint.heatPump_eta = heatPump.get_carnot().get_parameter();
+	}
+	else if(checkpoint.heatPump_type == HeatPumpVariant::tabulated)
+		checkpoint.heatPump_T_sink = heatPump.get_tabulated().get_T_sink();  // table itself is not stored
+	checkpoint.heatPump_COP = heatPump.get_COP();
+	checkpoint.heatPump_heat_sink = heatPump.get_heat_sink();
+
+	checkpoint.iterate_previous[0] = iterate_previous.Q_W;
+	checkpoint.iterate_previous[1] = iterate_previous.residual;
+	checkpoint.iterate_below[0] = iterate_below.Q_W;
+	checkpoint.iterate_below[1] = iterate_below.residual;
+	checkpoint.iterate_above[0] = iterate_above.Q_W;
+	checkpoint.iterate_above[1] = iterate_above.residual;
+	checkpoint.powerrate_previous[0] = powerrate_previous.Q_H;
+	checkpoint.powerrate_previous[1] = powerrate_previous.residual;
+	checkpoint.powerrate_sensitivity = powerrate_sensitivity;
+	checkpoint.Q_H_demand = Q_H_demand;
+
+	checkpoint.scheme_ID = _scheme_ID;
+	checkpoint.storage_state = result.storage_state;
+	checkpoint.operationType = (operationType == storing) ? 0 : 1;
+	checkpoint.flowrate_adaption = flowrate_adaption;
+	checkpoint.powerrate_adaption = powerrate_adaption;
+	checkpoint.iterate_previous_set = iterate_previous.set;
+	checkpoint.iterate_below_set = iterate_below.set;
+	checkpoint.iterate_above_set = iterate_above.set;
+	checkpoint.powerrate_previous_set = powerrate_previous.set;
+	checkpoint.warm_start = warm_start;
+	checkpoint.previous_timeStep = previous_timeStep;
+	checkpoint.statistics_enabled = statistics_enabled;
+}
+
+bool WellDoubletControl::restore_state(const checkpoint_t& checkpoint)
+{
+	if(checkpoint.scheme_ID != _scheme_ID)
+		return false;
+	result = { checkpoint.Q_H, checkpoint.Q_W, checkpoint.Q_H_sys, checkpoint.T_HE, checkpoint.T_UA,
+			static_cast<storage_state_t>(checkpoint.storage_state) };
+	Q_H_sys_target = checkpoint.Q_H_sys_target;
+	Q_H_sys_old = checkpoint.Q_H_sys_old;
+	Q_W_old = checkpoint.Q_W_old;
+	volumetricHeatCapacity_HE = checkpoint.volumetricHeatCapacity_HE;
+	volumetricHeatCapacity_UA = checkpoint.volumetricHeatCapacity_UA;
+	value_target = checkpoint.value_target;
+	value_threshold = checkpoint.value_threshold;
+	flowrate_adaption_factor = checkpoint.flowrate_adaption_factor;
+	deltaTsign_stored = checkpoint.deltaTsign_stored;
+	well_shutdown_temperature_range = checkpoint.well_shutdown_temperature_range;
+	accuracies = { checkpoint.accuracy_temperature, checkpoint.accuracy_powerrate, checkpoint.accuracy_flowrate };
+
+	set_heatPump(checkpoint.heatPump_type, checkpoint.heatPump_T_sink, checkpoint.heatPump_eta);
+	heatPump.restore(checkpoint.heatPump_COP, checkpoint.heatPump_heat_sink);
+
+	iterate_previous = { checkpoint.iterate_previous[0], checkpoint.iterate_previous[1],
+				checkpoint.iterate_previous_set != 0 };
+	iterate_below = { checkpoint.iterate_below[0], checkpoint.iterate_below[1], checkpoint.iterate_below_set != 0 };
+	iterate_above = { checkpoint.iterate_above[0], checkpoint.iterate_above[1], checkpoint.iterate_above_set != 0 };
+	powerrate_previous = { checkpoint.powerrate_previous[0], checkpoint.powerrate_previous[1],
+				checkpoint.powerrate_previous_set != 0 };
+	powerrate_sensitivity = checkpoint.powerrate_sensitivity;
+	Q_H_demand = checkpoint.Q_H_demand;
+
+	operationType = (checkpoint.operationType == 0) ? storing : extracting;
+	flowrate_adaption = static_cast<flowrate_adaption_t>(checkpoint.flowrate_adaption);
+	powerrate_adaption = static_cast<powerrate_adaption_t>(checkpoint.powerrate_adaption);
+	warm_start = checkpoint.warm_start != 0;
+	previous_timeStep = checkpoint.previous_timeStep != 0;
+	statistics_enabled = checkpoint.statistics_enabled != 0;
+	return true;
+}
+
+void WellDoubletControlBatch::save_state(checkpoint_t* checkpoints) const
+{
+	for(std::size_t i=0; i<_size; ++i)
+	{
+		checkpoint_t& checkpoint = checkpoints[i];
+		std::memset(&checkpoint, 0, sizeof(checkpoint));
+		checkpoint.Q_H = Q_H[i];
+		checkpoint.Q_W = Q_W[i];
+		checkpoint.Q_H_sys = Q_H_sys[i];
+		checkpoint.T_HE = T_HE[i];
+		checkpoint.T_UA = T_UA[i];
+		checkpoint.Q_H_sys_target = Q_H_sys_target[i];
+		checkpoint.Q_H_sys_old = Q_H_sys_old[i];
+		checkpoint.Q_W_old = Q_W_old[i];
+		checkpoint.volumetricHeatCapacity_HE = volumetricHeatCapacity_HE[i];
+		checkpoint.volumetricHeatCapacity_UA = volumetricHeatCapacity_UA[i];
+		checkpoint.value_target = value_target[i];
+		checkpoint.value_threshold = value_threshold[i];
+		checkpoint.flowrate_adaption_factor = flowrate_adaption_factor[i];
+		checkpoint.deltaTsign_stored = deltaTsign_stored[i];
+		checkpoint.well_shutdown_temperature_range = well_shutdown_temperature_range;
+		checkpoint.accuracy_temperature = accuracies.temperature;
+		checkpoint.accuracy_powerrate = accuracies.powerrate;
+		checkpoint.accuracy_flowrate = accuracies.flowrate;
+		checkpoint.heatPump_type = heatPump_type[i];
+		checkpoint.heatPump_T_sink = heatPump_T_sink[i];
+		checkpoint.heatPump_eta = heatPump_eta[i];
+		checkpoint.heatPump_COP = COP[i];
+		checkpoint.heatPump_heat_sink = heatPump_heat_sink[i];
+		checkpoint.scheme_ID = _scheme_ID;
+		checkpoint.storage_state = storage_state[i];
+		checkpoint.operationType = storing[i] ? 0 : 1;
+		checkpoint.flowrate_adaption = WellDoubletControl::fixed_point;
+		checkpoint.powerrate_adaption = WellDoubletControl::fixed_gain;
+		checkpoint.previous_timeStep = (Q_W[i] != 0.);  // configured
+		checkpoint.Q_H_demand = Q_H_sys_target[i];
+	}
+}
+
+bool WellDoubletControlBatch::restore_state(const checkpoint_t* checkpoints)
+{
+	for(std::size_t i=0; i<_size; ++i)
+		if(checkpoints[i].scheme_ID != _scheme_ID)
+			return false;
+	if(_size > 0)
+	{
+		well_shutdown_temperature_range = checkpoints[0].well_shutdown_temperature_range;
+		accuracies = { checkpoints[0].accuracy_temperature, checkpoints[0].accuracy_powerrate,
+				checkpoints[0].accuracy_flowrate };
+	}
+	for(std::size_t i=0; i<_size; ++i)
+	{
+		const checkpoint_t& checkpoint = checkpoints[i];
+		Q_H[i] = checkpoint.Q_H;
+		Q_W[i] = checkpoint.Q_W;
+		Q_H_sys[i] = checkpoint.Q_H_sys;
+		T_HE[i] = checkpoint.T_HE;
+		T_UA[i] = checkpoint.T_UA;
+		storage_state[i] = static_cast<storage_state_t>(checkpoint.storage_state);
+		Q_H_sys_target[i] = checkpoint.Q_H_sys_target;
+		Q_H_sys_old[i] = checkpoint.Q_H_sys_old;
+		Q_W_old[i] = checkpoint.Q_W_old;
+		volumetricHeatCapacity_HE[i] = checkpoint.volumetricHeatCapacity_HE;
+		volumetricHeatCapacity_UA[i] = checkpoint.volumetricHeatCapacity_UA;
+		value_target[i] = checkpoint.value_target;
+		value_threshold[i] = checkpoint.value_threshold;
+		flowrate_adaption_factor[i] = checkpoint.flowrate_adaption_factor;
+		deltaTsign_stored[i] = checkpoint.deltaTsign_stored;
+		heatPump_type[i] = (checkpoint.heatPump_type == 2 && !heatPumpTable) ? 0 : checkpoint.heatPump_type;
+		heatPump_T_sink[i] = checkpoint.heatPump_T_sink;
+		heatPump_eta[i] = checkpoint.heatPump_eta;
+		COP[i] = checkpoint.heatPump_COP;
+		heatPump_heat_sink[i] = checkpoint.heatPump_heat_sink;
+
+		// derived as in configure
+		storing[i] = (checkpoint.operationType == 0);
+		sigma[i] = storing[i] ? -1. : 1.;
+		const double flowrate_limit = (_scheme_ID == 0) ? value_target[i] : value_threshold[i];
+		flowrate_lower[i] = storing[i] ? accuracies.flowrate : flowrate_limit;
+		flowrate_upper[i] = storing[i] ? flowrate_limit : -accuracies.flowrate;
+	}
+	make_operabilities();
+	return true;
+}
+
+
+std::size_t get_checkpoint_size(const std::size_t& numberOfRecords)
+{
+	return sizeof(checkpoint_header_t) + numberOfRecords * sizeof(checkpoint_t);
+}
+
+void write_checkpoint(const WellDoubletControl* const* controllers, const std::size_t& n, void* buffer)
+{
+	checkpoint_t* records = write_header(buffer, n);
+	for(std::size_t i=0; i<n; ++i)
+		controllers[i]->save_state(records[i]);
+}
+
+void write_checkpoint(const WellDoubletControlBatch& batch, void* buffer)
+{
+	batch.save_state(write_header(buffer, batch.size()));
+}
+
+std::size_t get_numberOfRecords(const void* buffer, const std::size_t& size)
+{
+	checkpoint_header_t header;
+	if(buffer == nullptr || size < sizeof(header))
+		return 0;
+	std::memcpy(&header, buffer, sizeof(header));
+	if(std::memcmp(header.magic, c_magic, sizeof(c_magic)) != 0 || header.version != c_checkpointVersion ||
+			header.recordSize != sizeof(checkpoint_t) || header.byteOrder != c_byteOrder ||
+			size < get_checkpoint_size(header.numberOfRecords))
+		return 0;
+	return header.numberOfRecords;
+}
+
+const checkpoint_t* get_records(const void* buffer)
+{
+	return reinterpret_cast<const checkpoint_t*>(static_cast<const char*>(buffer) + sizeof(checkpoint_header_t));
+}
+
+bool read_checkpoint(const void* buffer, const std::size_t& size,
+	WellDoubletControl** controllers, const std::size_t& n)
+{
+	if(n == 0 || get_numberOfRecords(buffer, size) != n)
+		return false;
+	const checkpoint_t* records = get_records(buffer);
+	if(!are_valid(records, n))
+		return false;
+	for(std::size_t i=0; i<n; ++i)
+		if(controllers[i] != nullptr && controllers[i]->get_scheme_ID() != records[i].scheme_ID)
+			return false;
+	for(std::size_t i=0; i<n; ++i)
+	{
+		if(controllers[i] == nullptr)
+			controllers[i] = WellDoubletControl::create_wellDoubletControl(records[i].scheme_ID,
+				records[i].well_shutdown_temperature_range, { records[i].accuracy_temperature,
+				records[i].accuracy_powerrate, records[i].accuracy_flowrate });
+		controllers[i]->restore_state(records[i]);
+	}
+	return true;
+}
+
+bool read_checkpoint(const void* buffer, const std::size_t& size, WellDoubletControlBatch& batch)
+{
+	if(batch.size() == 0 || get_numberOfRecords(buffer, size) != batch.size() ||
+			!are_valid(get_records(buffer), batch.size()))
+		return false;
+	return batch.restore_state(get_records(buffer));
+}
+
+bool save_checkpoint(const std::string& path, const WellDoubletControl* const* controllers, const std::size_t& n)
+{
+	std::vector<char> buffer(get_checkpoint_size(n));
+	write_checkpoint(controllers, n, buffer.data());
+	return write_file(path, buffer);
+}
+
+bool save_checkpoint(const std::string& path, const WellDoubletControlBatch& batch)
+{
+	std::vector<char> buffer(get_checkpoint_size(batch.size()));
+	write_checkpoint(batch, buffer.data());
+	return write_file(path, buffer);
+}
+
+bool load_checkpoint(const std::string& path, WellDoubletControl** controllers, const std::size_t& n)
+{
+	std::vector<char> buffer;
+	return read_file(path, buffer) && read_checkpoint(buffer.data(), buffer.size(), controllers, n);
+}
+
+bool load_checkpoint(const std::string& path, WellDoubletControlBatch& batch)
+{
+	std::vector<char> buffer;
+	return read_file(path, buffer) && read_checkpoint(buffer.data(), buffer.size(), batch);
+}
+
+} // end namespace wdc
@@ -0,0 +1,74 @@
+#ifndef WDC_CHECKPOINT_H
+#define WDC_CHECKPOINT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+#include "wellDoubletControl.h"
+#include "wellDoubletControlBatch.h"
+
+namespace wdc
+{
+
+// binary checkpoint of controller states to restart a simulation
+// layout: checkpoint_header_t followed by one checkpoint_t per controller (contiguous)
+// single controllers and batches write the same records - they can be restored into each other
+// (a batch keeps accuracies and shutdown range of its first record, a batch has no secant / newton iterates)
+// records are written in the byte order of the host - read_checkpoint rejects other byte orders and versions
+// statistics are not part of the state, COP tables neither (heat pump type 2 needs set_heatPumpTable before restore)
+const std::uint32_t c_checkpointVersion = 1;
+
+struct checkpoint_header_t
+{
+	char magic[4];  // "WDCC"
+	std::uint32_t version;
+	std::uint32_t recordSize;  // sizeof(checkpoint_t)
+	std::uint32_t byteOrder;  // 0x01020304 as written by host
+	std::uint64_t numberOfRecords;
+};
+
+struct checkpoint_t  // plain data - add fields only with a new version
+{
+	double Q_H, Q_W, Q_H_sys, T_HE, T_UA;  // result_t
+	double Q_H_sys_target, Q_H_sys_old, Q_W_old;
+	double volumetricHeatCapacity_HE, volumetricHeatCapacity_UA, value_target, value_threshold;
+	double flowrate_adaption_factor, deltaTsign_stored;
+	double well_shutdown_temperature_range, accuracy_temperature, accuracy_powerrate, accuracy_flowrate;
+	double heatPump_T_sink, heatPump_eta, heatPump_COP, heatPump_heat_sink;
+	double iterate_previous[2], iterate_below[2], iterate_above[2];  // Q_W, residual
+	double powerrate_previous[2];  // Q_H, residual
+	double powerrate_sensitivity, Q_H_demand;
+
+	std::int32_t scheme_ID, storage_state, operationType;  // 0 storing, 1 extracting
+	std::int32_t heatPump_type, flowrate_adaption, powerrate_adaption;
+	std::uint8_t iterate_previous_set, iterate_below_set, iterate_above_set, powerrate_previous_set;
+	std::uint8_t warm_start, previous_timeStep, statistics_enabled, reserved;
+};
+
+std::size_t get_checkpoint_size(const std::size_t& numberOfRecords);  // in bytes, with header
+
+// into buffer of get_checkpoint_size(n) bytes
+void write_checkpoint(const WellDoubletControl* const* controllers, const std::size_t& n, void* buffer);
+void write_checkpoint(const WellDoubletControlBatch& batch, void* buffer);
+
+// buffer can be a memory mapped file
+std::size_t get_numberOfRecords(const void* buffer, const std::size_t& size);
+			// 0 if buffer is not a checkpoint of this version and byte order
+const checkpoint_t* get_records(const void* buffer);
+bool read_checkpoint(const void* buffer, const std::size_t& size,
+	WellDoubletControl** controllers, const std::size_t& n);
+			// null controllers are created with the scheme of their record
+			// fails if numbers of records or schemes differ or an enum field is out of range
+			// (checked for all records before any controller is restored)
+bool read_checkpoint(const void* buffer, const std::size_t& size, WellDoubletControlBatch& batch);
+
+// one write / one read of the whole checkpoint
+bool save_checkpoint(const std::string& path, const WellDoubletControl* const* controllers, const std::size_t& n);
+bool save_checkpoint(const std::string& path, const WellDoubletControlBatch& batch);
+bool load_checkpoint(const std::string& path, WellDoubletControl** controllers, const std::size_t& n);
+bool load_checkpoint(const std::string& path, WellDoubletControlBatch& batch);
+
+} // end namespace wdc
+
+#endif
@@ -4,55 +4,23 @@
 #include <iostream>
 #include <cmath>
 #include <cassert>
-#include <memory>
 
 namespace wdc
 {
 
-struct Greater;
-struct Smaller;
-
-struct ComparisonMethod
-{
-        virtual bool execute(const double& x, const double& y) const = 0;
-        virtual ~ComparisonMethod() {}
-};
-
-struct Greater : public ComparisonMethod
+// used by the scheme policies (wellDoubletControl.h)
+struct Greater
 {
-        double epsilon;
-        Greater(const double& _epsilon) { epsilon = _epsilon; }
-        bool execute(const double& x, const double& y) const 
+        static bool compare(const double& x, const double& y, const double& epsilon)
         { return x > y + epsilon; }
 };
 
-struct Smaller : public ComparisonMethod
+struct Smaller
 {
-        double epsilon;
-        Smaller(const double& _epsilon) { epsilon = _epsilon; }
-        bool execute(const double& x, const double& y) const
+        static bool compare(const double& x, const double& y, const double& epsilon)
         { return x < y - epsilon; }
 };
 
-struct Comparison
-{
-        std::unique_ptr<ComparisonMethod> method;
-
-        Comparison() = default;
-        Comparison(ComparisonMethod* _method) : method(std::unique_ptr<ComparisonMethod>(_method)) {}
-
-        void configure(ComparisonMethod* _method)
-	{
-		method = std::unique_ptr<ComparisonMethod>(_method);
-	}
-
-        bool operator()(const double& x, const double& y) const
-        {
-                return method->execute(x, y);
-        }
-
-};
-
 inline double make_confined(const double& value, const double& lower_limit, const double& upper_limit)
 {
 	return fmin(fmax(value, lower_limit), upper_limit);
@@ -0,0 +1,90 @@
+#include <cmath>
+#include <algorithm>
+#include "couplingDriver.h"
+
+namespace wdc
+{
+
+void CouplingDriver::start(WellDoubletControl* _wellDoubletControl, const double& Q_H, const double& value_target,
+	const double& value_threshold, const WellDoubletControl::balancing_properties_t& balancing_properties)
+{
+	if((state == solve || state == error) && error_previous > 0.)
+		wellDoubletControl->set_accuracies(accuracies);  // time step was left with loosened tolerance
+	wellDoubletControl = _wellDoubletControl;
+	wellDoubletControl->configure(Q_H, value_target, value_threshold, balancing_properties);
+	accuracies = wellDoubletControl->get_accuracies();
+	eta = forcing.eta_max;
+	error_previous = 0.;
+	iteration = 0;
+	state = (maxNumberOfIterations > 0) ? solve : not_converged;
+}
+
+void CouplingDriver::next_iteration()
+{
+	++iteration;
+	if(iteration < maxNumberOfIterations)
+		state = solve;
+	else
+		finish(not_converged);
+}
+
+void CouplingDriver::finish(const state_t& _state)
+{
+	if(tolerance == adaptive_tolerance)
+		wellDoubletControl->set_accuracies(accuracies);
+	state = _state;
+}
+
+void CouplingDriver::adapt_tolerance(const double& _error)
+{
+	if(error_previous > 0.)
+	{
+		double _eta = forcing.gamma * std::pow(_error / error_previous, forcing.alpha);
+		const double safeguard = forcing.gamma * std::pow(eta, forcing.alpha);
+		if(safeguard > 0.1)
+			_eta = std::max(_eta, safeguard);
+		eta = std::min(_eta, forcing.eta_max);
+	}
+	error_previous = _error;
+	WellDoubletControl::accuracies_t loose = accuracies;
+	loose.temperature = std::max(accuracies.temperature, eta * _error);
+	wellDoubletControl->set_accuracies(loose);
+}
+
+CouplingDriver::state_t CouplingDriver::evaluate(const WellDoubletControl::balancing_properties_t& balancing_properties)
+{
+	if(state != solve)
+		return state;
+	wellDoubletControl->evaluate_simulation_result(balancing_properties);
+	if(iteration >= minNumberOfIterations-2)
+		state = error;
+	else
+		next_iteration();
+	return state;
+}
+
+void CouplingDriver::resume()
+{
+	if(state == converged)
+		next_iteration();
+}
+
+CouplingDriver::state_t CouplingDriver::check(const double& _error)
+{
+	if(state != error)
+		return state;
+	if(tolerance == adaptive_tolerance)
+	{
+		if(_error < accuracy_temperature)
+			wellDoubletControl->set_accuracies(accuracies);  // converged is checked with these
+		else
+			adapt_tolerance(_error);
+	}
+	if(_error < accuracy_temperature && wellDoubletControl->converged())
+		finish(converged);
+	else
+		next_iteration();
+	return state;
+}
+
+}
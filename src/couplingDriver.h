@@ -0,0 +1,78 @@
+#ifndef WDC_COUPLING_DRIVER_H
+#define WDC_COUPLING_DRIVER_H
+
+#include "wellDoubletControl.h"
+
+namespace wdc
+{
+
+// coupling iterations of one time step as resumable state machine - the loop of hosts (as FakeSimulator)
+// the driver returns to the host whenever it needs the simulator, hosts with asynchronous or batched
+// solvers keep one driver per doublet and advance all of them from one thread
+// 	start: configures the controller                                      -> solve
+// 	solve: host solves with get_request(), passes the balancing properties to evaluate
+// 		-> solve (below minimum number of iterations) or error
+// 	error: host passes its change of temperatures to the previous iteration to check
+// 		-> converged (error below accuracy and controller converged), solve, or not_converged (maximum reached)
+// 	converged: hosts coupling several doublets to one field (FieldSimulator) resume converged drivers
+// 		while others iterate - the field still changes                -> solve or not_converged
+// the error is requested only when it is checked (hosts can update their previous iteration in between)
+// adaptive_tolerance (inexact coupling, forcing terms of Eisenstat and Walker, choice 2):
+// 	eta_k = gamma * (error_k / error_k-1)^alpha, safeguarded by gamma * eta_k-1^alpha if that is above 0.1,
+// 	at most eta_max - the controller compares temperatures with max(accuracy, eta_k * error_k)
+// 	while the simulator error is above accuracy_temperature (powerrate and flowrate accuracies are
+// 	also shutdown limits and are kept), convergence is always checked with the accuracies of the controller
+// 	(restored when finished or when the driver is started again before)
+class CouplingDriver
+{
+public:
+	enum state_t { idle, solve, error, converged, not_converged };
+	enum tolerance_t { fixed_tolerance, adaptive_tolerance };
+	struct request_t { double Q_H, Q_W; };  // rates for the simulator
+	struct forcing_t { double gamma, alpha, eta_max; };
+private:
+	WellDoubletControl* wellDoubletControl;
+	int minNumberOfIterations, maxNumberOfIterations;
+	double accuracy_temperature;
+	state_t state;
+	int iteration;
+	tolerance_t tolerance;
+	forcing_t forcing;
+	WellDoubletControl::accuracies_t accuracies;  // of the controller at start
+	double eta, error_previous;
+
+	void next_iteration();
+	void adapt_tolerance(const double& _error);
+	void finish(const state_t& _state);
+public:
+	CouplingDriver(const int& _minNumberOfIterations = 3, const int& _maxNumberOfIterations = 200,
+		const double& _accuracy_temperature = 0.01) :
+		wellDoubletControl(nullptr), minNumberOfIterations(_minNumberOfIterations),
+		maxNumberOfIterations(_maxNumberOfIterations), accuracy_temperature(_accuracy_temperature),
+		state(idle), iteration(0), tolerance(fixed_tolerance), forcing({ 0.9, 2., 0.9 }),
+		accuracies({ 0., 0., 0. }), eta(0.), error_previous(0.) {}
+
+	void start(WellDoubletControl* _wellDoubletControl, const double& Q_H, const double& value_target,
+		const double& value_threshold, const WellDoubletControl::balancing_properties_t& balancing_properties);
+			// beginning of time step - the controller is not owned
+	state_t evaluate(const WellDoubletControl::balancing_properties_t& balancing_properties);  // in state solve
+	state_t check(const double& _error);  // in state error
+	void resume();  // in state converged - continues iterations without configuring the controller
+
+	void set_tolerance(const tolerance_t& _tolerance) { tolerance = _tolerance; }  // default fixed_tolerance
+	tolerance_t get_tolerance() const { return tolerance; }
+	void set_forcing(const forcing_t& _forcing) { forcing = _forcing; }  // default gamma 0.9, alpha 2, eta_max 0.9
+	double get_forcingTerm() const { return eta; }  // of last adaption
+
+	state_t get_state() const { return state; }
+	bool finished() const { return state == converged || state == not_converged; }
+	request_t get_request() const
+	{ return { wellDoubletControl->get_result().Q_H, wellDoubletControl->get_result().Q_W }; }
+	int get_iteration() const { return iteration; }  // maximum number of iterations if not converged
+	int get_numberOfIterations() const { return (state == not_converged) ? iteration : iteration + 1; }
+	const WellDoubletControl* get_wellDoubletControl() const { return wellDoubletControl; }
+};
+
+}
+
+#endif
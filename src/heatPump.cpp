@@ -1,34 +1,169 @@
 #include "heatPump.h"
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
 
 namespace wdc
 {
 
-double CarnotHeatPump::calculate_heat_source(const double& _heat_sink,
-		const double& T_source_in, const double& T_source_out)
+namespace
 {
-	const double conversion = (T_sink>200)? 0: 273.15; // °C->K
-	COP = eta * (T_sink + conversion) / (T_sink - T_source_in);
-	if(COP < 0.)
+
+const std::size_t c_maximumNumberOfBins = 1 << 16;
+
+bool make_axis(const std::vector<double>& values, COPTable::axis_t& axis)
+{
+	if(values.size() < 2)
+		return false;
+	double spacing = values[1] - values[0];
+	for(std::size_t i=1; i<values.size(); ++i)
 	{
-		COP = -1;
-		return _heat_sink;
+		if(!(values[i] > values[i-1]))
+			return false;  // not ascending (or NaN)
+		spacing = std::min(spacing, values[i] - values[i-1]);
 	}
-	else
+	// bins are not wider than the smallest interval - a bin contains at most one axis value inside
+	const double span = values.back() - values.front();
+	if(span / spacing > c_maximumNumberOfBins)
+		return false;
+	const std::size_t numberOfBins = std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil(span / spacing)));
+	axis.values = values;
+	axis.inverse_binWidth = numberOfBins / span;
+	axis.intervals.resize(numberOfBins);
+	std::size_t interval = 0;
+	for(std::size_t bin=0; bin<numberOfBins; ++bin)
 	{
-		heat_sink = _heat_sink;
-		//WDC_LOG("Carnot COP: " << COP);
-		return _heat_sink * (COP-1) / COP;
+		const double start = values.front() + bin / axis.inverse_binWidth;
+		while(interval + 2 < values.size() && values[interval+1] <= start)
+			++interval;
+		axis.intervals[bin] = interval;
 	}
+	return true;
 }
 
+}  // end anonymous namespace
 
-double NoHeatPump::calculate_heat_source(const double& _heat_sink,
-		const double& T_source_in, const double& T_source_out)
+
+void COPTable::axis_t::locate(const double& value, std::size_t& interval, double& weight) const
+{
+	const double clamped = std::min(std::max(value, values.front()), values.back());
+	const std::size_t bin = std::min(static_cast<std::size_t>((clamped - values.front()) * inverse_binWidth),
+					intervals.size() - 1);
+	interval = intervals[bin];
+	interval += (clamped >= values[interval+1]) & (interval + 2 < values.size());
+	weight = (clamped - values[interval]) / (values[interval+1] - values[interval]);
+}
+
+std::shared_ptr<const COPTable> COPTable::create(const std::vector<double>& T_source,
+	const std::vector<double>& T_sink, const std::vector<double>& COP)
+{
+	std::shared_ptr<COPTable> table(new COPTable());
+	if(!make_axis(T_source, table->T_source) || !make_axis(T_sink, table->T_sink) ||
+			COP.size() != T_source.size() * T_sink.size())
+		return nullptr;
+	table->COP = COP;
+	return table;
+}
+
+std::shared_ptr<const COPTable> COPTable::load(const std::string& path)
+{
+	std::ifstream stream(path);
+	std::vector<double> T_source, T_sink, COP;
+	std::string line;
+	while(std::getline(stream, line))
+	{
+		std::istringstream input(line.substr(0, line.find('#')));
+		std::vector<double> values;
+		double value;
+		while(input >> value)
+			values.push_back(value);
+		if(values.empty())
+			continue;
+		if(T_sink.empty())
+			T_sink = values;
+		else
+		{
+			if(values.size() != T_sink.size() + 1)
+				return nullptr;
+			T_source.push_back(values[0]);
+			COP.insert(COP.end(), values.begin() + 1, values.end());
+		}
+	}
+	return create(T_source, T_sink, COP);
+}
+
+double COPTable::interpolate(const double& _T_source, const double& _T_sink) const
+{	// along sink temperature first
+	std::size_t i, j;
+	double u, v;
+	T_source.locate(_T_source, i, u);
+	T_sink.locate(_T_sink, j, v);
+	const std::size_t m = T_sink.values.size();
+	const double* row = &COP[i * m + j];
+	const double lower = row[0] + v * (row[1] - row[0]);
+	const double upper = row[m] + v * (row[m+1] - row[m]);
+	return lower + u * (upper - lower);
+}
+
+void COPTable::interpolate(const double* _T_source, const double* _T_sink, double* _COP, const std::size_t& n) const
+{
+	for(std::size_t k=0; k<n; ++k)
+		_COP[k] = interpolate(_T_source[k], _T_sink[k]);
+}
+
+double COPTable::interpolate(const double& _T_source, const std::size_t& sinkInterval, const double& sinkWeight) const
+{	// as interpolate above
+	std::size_t i;
+	double u;
+	T_source.locate(_T_source, i, u);
+	const std::size_t m = T_sink.values.size();
+	const double* row = &COP[i * m + sinkInterval];
+	const double lower = row[0] + sinkWeight * (row[1] - row[0]);
+	const double upper = row[m] + sinkWeight * (row[m+1] - row[m]);
+	return lower + u * (upper - lower);
+}
+
+void COPTable::interpolate(const double* _T_source, const double& _T_sink, double* _COP, const std::size_t& n) const
+{	// sink interval located once
+	std::size_t j;
+	double v;
+	T_sink.locate(_T_sink, j, v);
+	for(std::size_t k=0; k<n; ++k)
+		_COP[k] = interpolate(_T_source[k], j, v);
+}
+
+
+TabulatedHeatPump::TabulatedHeatPump(const COPTable* _table, const double& _T_sink) :
+	table(_table), T_sink(_T_sink), sinkInterval(0), sinkWeight(0.)
+{
+	if(table)
+		table->get_T_sink().locate(T_sink, sinkInterval, sinkWeight);
+}
+
+double TabulatedHeatPump::calculate_COP(const double& T_source_in) const
+{
+	if(table == nullptr)
+		return -1.;
+	const double _COP = table->interpolate(T_source_in, sinkInterval, sinkWeight);
+	return (_COP > 1.) ? _COP : -1.;
+}
+
+void TabulatedHeatPump::calculate_COPs(const double* T_source_in, double* _COP, const std::size_t& n) const
 {
+	for(std::size_t k=0; k<n; ++k)
+		_COP[k] = calculate_COP(T_source_in[k]);
+}
+
+double TabulatedHeatPump::calculate_heat_source(const double& _heat_sink,
+		const double& T_source_in, const double& T_source_out)
+{	// as CarnotHeatPump
+	COP = calculate_COP(T_source_in);
+	if(COP < 0.)
+		return _heat_sink;
 	heat_sink = _heat_sink;
-	COP = -1.;
-	return _heat_sink;
+	return _heat_sink * (COP-1) / COP;
 }
 
 }
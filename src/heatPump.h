@@ -1,29 +1,44 @@
 #ifndef HEAT_PUMP_H
 #define HEAT_PUMP_H
 
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstddef>
+#include <new>
+#include <type_traits>
 #include "wdc_config.h"
 
 namespace wdc
 {
 
+// coefficient of performance of a Carnot heat pump - negative if not operable
+inline double carnot_COP(const double& T_sink, const double& eta, const double& T_source_in)
+{
+	const double conversion = (T_sink>200)? 0: 273.15; // °C->K
+	return eta * (T_sink + conversion) / (T_sink - T_source_in);
+}
+
+
 class HeatPump
 {
 protected:
 	double COP;
 	double heat_sink;
 public:
-	HeatPump() : COP(-1.) {}
+	HeatPump() : COP(-1.), heat_sink(0.) {}
+	void reset() { COP = -1.; heat_sink = 0.; }  // keeps parameters
 	double get_COP() const { return COP; }
 	double get_heat_sink() const { return heat_sink; }
-	virtual double calculate_heat_source(const double& heat_sink,
-			const double& T_source_in, const double& T_source_out) = 0;
-	virtual double get_heat_sink(const double& heat_source) const = 0;
-	virtual double get_parameter() const = 0;
-	virtual ~HeatPump() = default;
+	void restore(const double& _COP, const double& _heat_sink) { COP = _COP; heat_sink = _heat_sink; }
+				// from checkpoint
+	// models provide calculate_heat_source(heat_sink, T_source_in, T_source_out),
+	// get_heat_sink(heat_source) and get_parameter() - called through HeatPumpVariant (no virtual functions,
+	// models are trivially copyable)
 };
 
 
-class CarnotHeatPump : public HeatPump
+class CarnotHeatPump final : public HeatPump
 {
 	double T_sink;  // into sink
        	double	eta;  // Guetefaktor
@@ -32,22 +47,171 @@ public:
 	{
 		//WDC_LOG("Carnot - T_sink: " << T_sink << ", eta: " << eta);
 	}
-	double calculate_heat_source(const double& heat_sink, 
-			const double& T_source_in, const double& T_source_out) override;
-	double get_heat_sink(const double& heat_source) const override { return heat_source * COP / (COP-1); }
-	double get_parameter() const override { return eta; }
+	double calculate_heat_source(const double& _heat_sink,
+			const double& T_source_in, const double& T_source_out)
+	{
+		COP = carnot_COP(T_sink, eta, T_source_in);
+		if(COP < 0.)
+		{
+			COP = -1;
+			return _heat_sink;
+		}
+		heat_sink = _heat_sink;
+		//WDC_LOG("Carnot COP: " << COP);
+		return _heat_sink * (COP-1) / COP;
+	}
+	double get_heat_sink(const double& heat_source) const { return heat_source * COP / (COP-1); }
+	double get_parameter() const { return eta; }
+	double get_T_sink() const { return T_sink; }
+};
+
+
+// COP map of a heat pump over source (rows) and sink temperature (columns) - e.g. from manufacturer data
+// axes are ascending, not necessarily uniform - interval of a temperature is found with a precomputed
+// index over uniform bins (no search), temperatures outside the axes are clamped
+// tables are immutable and shared by the heat pumps which use them
+class COPTable
+{
+public:
+	struct axis_t
+	{
+		std::vector<double> values;
+		double inverse_binWidth;
+		std::vector<std::size_t> intervals;  // first interval of each uniform bin
+		void locate(const double& value, std::size_t& interval, double& weight) const;
+	};
+private:
+	axis_t T_source, T_sink;
+	std::vector<double> COP;  // row-major: COP[i * T_sink.values.size() + j]
+	COPTable() {}
+public:
+	static std::shared_ptr<const COPTable> create(const std::vector<double>& T_source,
+		const std::vector<double>& T_sink, const std::vector<double>& COP);
+			// nullptr if axes are not ascending, have less than two values or size does not match
+	static std::shared_ptr<const COPTable> load(const std::string& path);
+			// text: first line T_sink values, then one line per T_source: T_source COP ... ('#' comments)
+
+	const axis_t& get_T_source() const { return T_source; }
+	const axis_t& get_T_sink() const { return T_sink; }
+	double interpolate(const double& _T_source, const double& _T_sink) const;  // bilinear
+	double interpolate(const double& _T_source, const std::size_t& sinkInterval, const double& sinkWeight) const;
+			// sink temperature located before (get_T_sink().locate)
+	void interpolate(const double* _T_source, const double* _T_sink, double* _COP, const std::size_t& n) const;
+			// for many doublets
+	void interpolate(const double* _T_source, const double& _T_sink, double* _COP, const std::size_t& n) const;
+			// same sink temperature
+};
+
+
+// COP from COPTable at the given sink temperature - sink interval is located once
+// not operable (COP -1) if table COP is not above 1
+// the table is not owned (shared tables are kept by the controller) - it must outlive the heat pump
+class TabulatedHeatPump final : public HeatPump
+{
+	const COPTable* table;
+	double T_sink;
+	std::size_t sinkInterval;
+	double sinkWeight;
+public:
+	TabulatedHeatPump() : table(nullptr), T_sink(0.), sinkInterval(0), sinkWeight(0.) {}
+	TabulatedHeatPump(const COPTable* _table, const double& _T_sink);
+	double calculate_heat_source(const double& heat_sink,
+			const double& T_source_in, const double& T_source_out);
+	double get_heat_sink(const double& heat_source) const { return heat_source * COP / (COP-1); }
+	double get_parameter() const { return T_sink; }
+	double get_T_sink() const { return T_sink; }
+	const COPTable* get_table() const { return table; }
+	double calculate_COP(const double& T_source_in) const;
+	void calculate_COPs(const double* T_source_in, double* _COP, const std::size_t& n) const;
+			// for many doublets with this heat pump - not operable: -1
 };
 
 
-class NoHeatPump : public HeatPump
+class NoHeatPump final : public HeatPump
 {
 public:
-	double calculate_heat_source(const double& heat_sink, 
-			const double& T_source_in, const double& T_source_out) override;
-	double get_heat_sink(const double& heat_source) const override { return heat_source; }
-	double get_parameter() const override { return -1.; }
+	double calculate_heat_source(const double& _heat_sink,
+			const double& T_source_in, const double& T_source_out)
+	{ heat_sink = _heat_sink; COP = -1.; return _heat_sink; }
+	double get_heat_sink(const double& heat_source) const { return heat_source; }
+	double get_parameter() const { return -1.; }
 };
 
+
+// one of the heat pumps above stored inline (tagged union) - no allocation, trivially copyable
+// calls are dispatched by a switch on the type, the models are final, so calls are bound statically
+// and can be inlined (TabulatedHeatPump::calculate_heat_source is out of line)
+class HeatPumpVariant
+{
+public:
+	enum type_t { none = 0, carnot = 1, tabulated = 2 };  // as set_heatPump
+private:
+	type_t type;
+	union
+	{
+		NoHeatPump noHeatPump;
+		CarnotHeatPump carnotHeatPump;
+		TabulatedHeatPump tabulatedHeatPump;
+	};
+
+	const HeatPump& base() const
+	{
+		switch(type)
+		{
+			case carnot: return carnotHeatPump;
+			case tabulated: return tabulatedHeatPump;
+			default: return noHeatPump;
+		}
+	}
+	HeatPump& base() { return const_cast<HeatPump&>(static_cast<const HeatPumpVariant*>(this)->base()); }
+public:
+	HeatPumpVariant() : type(none), noHeatPump() {}
+
+	void set(const NoHeatPump& heatPump) { type = none; new (&noHeatPump) NoHeatPump(heatPump); }
+	void set(const CarnotHeatPump& heatPump) { type = carnot; new (&carnotHeatPump) CarnotHeatPump(heatPump); }
+	void set(const TabulatedHeatPump& heatPump)
+	{ type = tabulated; new (&tabulatedHeatPump) TabulatedHeatPump(heatPump); }
+
+	type_t get_type() const { return type; }
+	const CarnotHeatPump& get_carnot() const { return carnotHeatPump; }  // only if type is carnot
+	const TabulatedHeatPump& get_tabulated() const { return tabulatedHeatPump; }  // only if type is tabulated
+
+	double calculate_heat_source(const double& heat_sink, const double& T_source_in, const double& T_source_out)
+	{
+		switch(type)
+		{
+			case carnot: return carnotHeatPump.calculate_heat_source(heat_sink, T_source_in, T_source_out);
+			case tabulated: return tabulatedHeatPump.calculate_heat_source(heat_sink, T_source_in, T_source_out);
+			default: return noHeatPump.calculate_heat_source(heat_sink, T_source_in, T_source_out);
+		}
+	}
+	double get_heat_sink(const double& heat_source) const
+	{
+		switch(type)
+		{
+			case carnot: return carnotHeatPump.get_heat_sink(heat_source);
+			case tabulated: return tabulatedHeatPump.get_heat_sink(heat_source);
+			default: return noHeatPump.get_heat_sink(heat_source);
+		}
+	}
+	double get_parameter() const
+	{
+		switch(type)
+		{
+			case carnot: return carnotHeatPump.get_parameter();
+			case tabulated: return tabulatedHeatPump.get_parameter();
+			default: return noHeatPump.get_parameter();
+		}
+	}
+	// common state
+	void reset() { base().reset(); }
+	double get_COP() const { return base().get_COP(); }
+	double get_heat_sink() const { return base().get_heat_sink(); }
+	void restore(const double& _COP, const double& _heat_sink) { base().restore(_COP, _heat_sink); }
+};
+
+static_assert(std::is_trivially_copyable<HeatPumpVariant>::value, "heat pumps are copied with the controller");
+
 }
 
 #endif
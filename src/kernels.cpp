@@ -0,0 +1,305 @@
+#include <cstring>
+#include <cstdint>
+#include <cfloat>  // for DBL_MIN
+#include <cmath>
+#include "kernels.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+	#define WDC_SIMD_X86 1
+	#include <immintrin.h>
+	#define WDC_TARGET_AVX2 __attribute__((target("avx2,fma")))
+	#define WDC_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+	#define WDC_SIMD_X86 0
+#endif
+
+namespace wdc
+{
+namespace simd
+{
+
+namespace
+{
+
+const double c_sqrt2 = 1.4142135623730951;
+const double c_log2e = 1.4426950408889634;  // 1 / ln(2)
+const double c_ln2 = 0.6931471805599453;
+const double c_two52 = 4503599627370496.;  // 2^52 - to convert between double and exponent bits
+
+// coefficients of ln(m) = 2 s (1 + s^2/3 + s^4/5 + ... + s^14/15)
+const double c_atanh[8] = { 1., 1./3, 1./5, 1./7, 1./9, 1./11, 1./13, 1./15 };
+// coefficients of exp(t) = sum t^k/k!, k = 0..11
+const double c_exp[12] = { 1., 1., 1./2, 1./6, 1./24, 1./120, 1./720, 1./5040, 1./40320,
+				1./362880, 1./3628800, 1./39916800 };
+
+inline double fast_threshold_factor(const double& value, const double& threshold_value,
+		const double& sigma, const double& delta)
+{
+	const double U = sigma * (value - threshold_value) / delta;
+	return (U <= 0.) ? 0. : (( U < 1. ) ? fast_pow(U, 2*(1-U)) : 1. );
+}
+
+void make_threshold_factor_scalar(const double* value, const double* threshold_value, const double* sigma,
+		const double& delta, double* factor, const std::size_t& begin, const std::size_t& n)
+{
+	for(std::size_t i=begin; i<n; ++i)
+		factor[i] = wdc::make_threshold_factor(value[i], threshold_value[i], delta,
+				(sigma[i] > 0.) ? wdc::lower : wdc::upper);
+}
+
+void make_confined_scalar(const double* value, const double* lower_limit, const double* upper_limit,
+		double* confined, const std::size_t& begin, const std::size_t& n)
+{
+	for(std::size_t i=begin; i<n; ++i)
+		confined[i] = wdc::make_confined(value[i], lower_limit[i], upper_limit[i]);
+}
+
+#if WDC_SIMD_X86
+
+WDC_TARGET_AVX2 inline __m256d fast_pow_avx2(__m256d x, __m256d y)
+{
+	const __m256i xi = _mm256_castpd_si256(_mm256_max_pd(x, _mm256_set1_pd(DBL_MIN)));
+	// exponent
+	const __m256i two52 = _mm256_castpd_si256(_mm256_set1_pd(c_two52));
+	__m256d e = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(xi, 52), two52)),
+				_mm256_set1_pd(c_two52 + 1023.));
+	// mantissa in [sqrt(.5), sqrt(2))
+	__m256d m = _mm256_castsi256_pd(_mm256_or_si256(
+		_mm256_and_si256(xi, _mm256_set1_epi64x(0x000fffffffffffffLL)),
+		_mm256_set1_epi64x(0x3ff0000000000000LL)));
+	const __m256d large = _mm256_cmp_pd(m, _mm256_set1_pd(c_sqrt2), _CMP_GT_OQ);
+	m = _mm256_blendv_pd(m, _mm256_mul_pd(m, _mm256_set1_pd(.5)), large);
+	e = _mm256_add_pd(e, _mm256_and_pd(large, _mm256_set1_pd(1.)));
+
+	const __m256d one = _mm256_set1_pd(1.);
+	const __m256d s = _mm256_div_pd(_mm256_sub_pd(m, one), _mm256_add_pd(m, one));
+	const __m256d s2 = _mm256_mul_pd(s, s);
+	__m256d p = _mm256_set1_pd(c_atanh[7]);
+	for(int k=6; k>=0; --k)
+		p = _mm256_fmadd_pd(p, s2, _mm256_set1_pd(c_atanh[k]));
+	const __m256d ln_m = _mm256_mul_pd(_mm256_add_pd(s, s), p);
+
+	// exp2
+	const __m256d z_raw = _mm256_mul_pd(y, _mm256_fmadd_pd(ln_m, _mm256_set1_pd(c_log2e), e));
+	const __m256d underflow = _mm256_cmp_pd(z_raw, _mm256_set1_pd(-1022.), _CMP_LT_OQ);
+	const __m256d z = _mm256_min_pd(_mm256_max_pd(z_raw, _mm256_set1_pd(-1022.)), _mm256_set1_pd(1023.));
+	const __m256d n = _mm256_round_pd(z, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	const __m256d t = _mm256_mul_pd(_mm256_sub_pd(z, n), _mm256_set1_pd(c_ln2));
+	__m256d q = _mm256_set1_pd(c_exp[11]);
+	for(int k=10; k>=0; --k)
+		q = _mm256_fmadd_pd(q, t, _mm256_set1_pd(c_exp[k]));
+	const __m256d scale = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_castpd_si256(
+			_mm256_add_pd(n, _mm256_set1_pd(c_two52 + 1023.))), 52));
+	return _mm256_andnot_pd(underflow, _mm256_mul_pd(q, scale));
+}
+
+WDC_TARGET_AVX2 void make_threshold_factor_avx2(const double* value, const double* threshold_value,
+		const double* sigma, const double& delta, double* factor, const std::size_t& n)
+{
+	const __m256d zero = _mm256_setzero_pd(), one = _mm256_set1_pd(1.), two = _mm256_set1_pd(2.);
+	const __m256d _delta = _mm256_set1_pd(delta), tiny = _mm256_set1_pd(DBL_MIN);
+	std::size_t i = 0;
+	for(; i+4<=n; i+=4)
+	{
+		const __m256d U = _mm256_div_pd(_mm256_mul_pd(_mm256_loadu_pd(sigma + i),
+			_mm256_sub_pd(_mm256_loadu_pd(value + i), _mm256_loadu_pd(threshold_value + i))), _delta);
+		const __m256d U_confined = _mm256_min_pd(_mm256_max_pd(U, tiny), one);
+		const __m256d S = fast_pow_avx2(U_confined, _mm256_mul_pd(two, _mm256_sub_pd(one, U_confined)));
+		__m256d result = _mm256_blendv_pd(one, S, _mm256_cmp_pd(U, one, _CMP_LT_OQ));
+		result = _mm256_blendv_pd(result, zero, _mm256_cmp_pd(U, zero, _CMP_LE_OQ));
+		_mm256_storeu_pd(factor + i, result);
+	}
+	for(; i<n; ++i)
+		factor[i] = fast_threshold_factor(value[i], threshold_value[i], sigma[i], delta);
+}
+
+WDC_TARGET_AVX2 void make_confined_avx2(const double* value, const double* lower_limit,
+		const double* upper_limit, double* confined, const std::size_t& n)
+{
+	std::size_t i = 0;
+	for(; i+4<=n; i+=4)
+		_mm256_storeu_pd(confined + i, _mm256_min_pd(_mm256_max_pd(
+			_mm256_loadu_pd(value + i), _mm256_loadu_pd(lower_limit + i)), _mm256_loadu_pd(upper_limit + i)));
+	make_confined_scalar(value, lower_limit, upper_limit, confined, i, n);
+}
+
+// masked forms on all lanes - the plain intrinsics of gcc 12 pass an undefined source
+// and trip -Wmaybe-uninitialized (as advect_avx512)
+WDC_TARGET_AVX512 inline __m512d max_avx512(const __m512d& a, const __m512d& b)
+{ return _mm512_mask_max_pd(a, 0xff, a, b); }
+
+WDC_TARGET_AVX512 inline __m512d min_avx512(const __m512d& a, const __m512d& b)
+{ return _mm512_mask_min_pd(a, 0xff, a, b); }
+
+WDC_TARGET_AVX512 inline __m512d fast_pow_avx512(__m512d x, __m512d y)
+{
+	const __m512i xi = _mm512_castpd_si512(max_avx512(x, _mm512_set1_pd(DBL_MIN)));
+	const __m512i two52 = _mm512_castpd_si512(_mm512_set1_pd(c_two52));
+	__m512d e = _mm512_sub_pd(_mm512_castsi512_pd(_mm512_or_si512(_mm512_mask_srli_epi64(xi, 0xff, xi, 52), two52)),
+				_mm512_set1_pd(c_two52 + 1023.));
+	__m512d m = _mm512_castsi512_pd(_mm512_or_si512(
+		_mm512_and_si512(xi, _mm512_set1_epi64(0x000fffffffffffffLL)),
+		_mm512_set1_epi64(0x3ff0000000000000LL)));
+	const __mmask8 large = _mm512_cmp_pd_mask(m, _mm512_set1_pd(c_sqrt2), _CMP_GT_OQ);
+	m = _mm512_mask_mul_pd(m, large, m, _mm512_set1_pd(.5));
+	e = _mm512_mask_add_pd(e, large, e, _mm512_set1_pd(1.));
+
+	const __m512d one = _mm512_set1_pd(1.);
+	const __m512d s = _mm512_div_pd(_mm512_sub_pd(m, one), _mm512_add_pd(m, one));
+	const __m512d s2 = _mm512_mul_pd(s, s);
+	__m512d p = _mm512_set1_pd(c_atanh[7]);
+	for(int k=6; k>=0; --k)
+		p = _mm512_fmadd_pd(p, s2, _mm512_set1_pd(c_atanh[k]));
+	const __m512d ln_m = _mm512_mul_pd(_mm512_add_pd(s, s), p);
+
+	const __m512d z_raw = _mm512_mul_pd(y, _mm512_fmadd_pd(ln_m, _mm512_set1_pd(c_log2e), e));
+	const __mmask8 underflow = _mm512_cmp_pd_mask(z_raw, _mm512_set1_pd(-1022.), _CMP_LT_OQ);
+	const __m512d z = min_avx512(max_avx512(z_raw, _mm512_set1_pd(-1022.)), _mm512_set1_pd(1023.));
+	const __m512d n = _mm512_mask_roundscale_pd(z, 0xff, z, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	const __m512d t = _mm512_mul_pd(_mm512_sub_pd(z, n), _mm512_set1_pd(c_ln2));
+	__m512d q = _mm512_set1_pd(c_exp[11]);
+	for(int k=10; k>=0; --k)
+		q = _mm512_fmadd_pd(q, t, _mm512_set1_pd(c_exp[k]));
+	const __m512i biased = _mm512_castpd_si512(_mm512_add_pd(n, _mm512_set1_pd(c_two52 + 1023.)));
+	const __m512d scale = _mm512_castsi512_pd(_mm512_mask_slli_epi64(biased, 0xff, biased, 52));
+	return _mm512_maskz_mul_pd(static_cast<__mmask8>(~underflow), q, scale);
+}
+
+WDC_TARGET_AVX512 void make_threshold_factor_avx512(const double* value, const double* threshold_value,
+		const double* sigma, const double& delta, double* factor, const std::size_t& n)
+{
+	const __m512d zero = _mm512_setzero_pd(), one = _mm512_set1_pd(1.), two = _mm512_set1_pd(2.);
+	const __m512d _delta = _mm512_set1_pd(delta), tiny = _mm512_set1_pd(DBL_MIN);
+	std::size_t i = 0;
+	for(; i+8<=n; i+=8)
+	{
+		const __m512d U = _mm512_div_pd(_mm512_mul_pd(_mm512_loadu_pd(sigma + i),
+			_mm512_sub_pd(_mm512_loadu_pd(value + i), _mm512_loadu_pd(threshold_value + i))), _delta);
+		const __m512d U_confined = min_avx512(max_avx512(U, tiny), one);
+		const __m512d S = fast_pow_avx512(U_confined, _mm512_mul_pd(two, _mm512_sub_pd(one, U_confined)));
+		__m512d result = _mm512_mask_blend_pd(_mm512_cmp_pd_mask(U, one, _CMP_LT_OQ), one, S);
+		result = _mm512_mask_blend_pd(_mm512_cmp_pd_mask(U, zero, _CMP_LE_OQ), result, zero);
+		_mm512_storeu_pd(factor + i, result);
+	}
+	for(; i<n; ++i)
+		factor[i] = fast_threshold_factor(value[i], threshold_value[i], sigma[i], delta);
+}
+
+WDC_TARGET_AVX512 void make_confined_avx512(const double* value, const double* lower_limit,
+		const double* upper_limit, double* confined, const std::size_t& n)
+{
+	std::size_t i = 0;
+	for(; i+8<=n; i+=8)
+		_mm512_storeu_pd(confined + i, min_avx512(max_avx512(
+			_mm512_loadu_pd(value + i), _mm512_loadu_pd(lower_limit + i)), _mm512_loadu_pd(upper_limit + i)));
+	make_confined_scalar(value, lower_limit, upper_limit, confined, i, n);
+}
+
+#endif
+
+isa_t detect_isa()
+{
+#if WDC_SIMD_X86
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("avx512f"))
+		return avx512;
+	if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+		return avx2;
+#endif
+	return scalar;
+}
+
+}  // end anonymous namespace
+
+
+isa_t best_isa()
+{
+	static const isa_t isa = detect_isa();
+	return isa;
+}
+
+bool is_supported(const isa_t& isa)
+{
+	return isa <= best_isa();
+}
+
+const char* get_name(const isa_t& isa)
+{
+	switch(isa)
+	{
+		case avx512: return "avx512";
+		case avx2: return "avx2";
+		default: return "scalar";
+	}
+}
+
+double fast_pow(const double& x, const double& y)
+{
+	const double _x = (x < DBL_MIN) ? DBL_MIN : x;
+	uint64_t bits;
+	std::memcpy(&bits, &_x, sizeof(bits));
+	double e = static_cast<double>(bits >> 52) - 1023.;
+	bits = (bits & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL;
+	double m;
+	std::memcpy(&m, &bits, sizeof(m));
+	if(m > c_sqrt2)
+	{
+		m *= .5;
+		e += 1.;
+	}
+
+	const double s = (m - 1.) / (m + 1.), s2 = s * s;
+	double p = c_atanh[7];
+	for(int k=6; k>=0; --k)
+		p = p * s2 + c_atanh[k];
+	const double ln_m = 2. * s * p;
+
+	double z = y * (e + ln_m * c_log2e);
+	if(z < -1022.)
+		return 0.;
+	if(z > 1023.)
+		z = 1023.;
+	const double n = std::nearbyint(z);
+	const double t = (z - n) * c_ln2;
+	double q = c_exp[11];
+	for(int k=10; k>=0; --k)
+		q = q * t + c_exp[k];
+
+	bits = static_cast<uint64_t>(static_cast<int64_t>(n) + 1023) << 52;
+	double scale;
+	std::memcpy(&scale, &bits, sizeof(scale));
+	return q * scale;
+}
+
+void make_threshold_factor(const double* value, const double* threshold_value, const double* sigma,
+		const double& delta, double* factor, const std::size_t& n, const isa_t& isa)
+{
+	if(delta <= 0)
+	{
+		for(std::size_t i=0; i<n; ++i)
+			factor[i] = 1.;
+		return;
+	}
+#if WDC_SIMD_X86
+	if(isa == avx512 && is_supported(avx512))
+		return make_threshold_factor_avx512(value, threshold_value, sigma, delta, factor, n);
+	if(isa == avx2 && is_supported(avx2))
+		return make_threshold_factor_avx2(value, threshold_value, sigma, delta, factor, n);
+#endif
+	make_threshold_factor_scalar(value, threshold_value, sigma, delta, factor, 0, n);
+}
+
+void make_confined(const double* value, const double* lower_limit, const double* upper_limit,
+		double* confined, const std::size_t& n, const isa_t& isa)
+{
+#if WDC_SIMD_X86
+	if(isa == avx512 && is_supported(avx512))
+		return make_confined_avx512(value, lower_limit, upper_limit, confined, n);
+	if(isa == avx2 && is_supported(avx2))
+		return make_confined_avx2(value, lower_limit, upper_limit, confined, n);
+#endif
+	make_confined_scalar(value, lower_limit, upper_limit, confined, 0, n);
+}
+
+}  // end namespace simd
+}  // end namespace wdc
@@ -0,0 +1,43 @@
+#ifndef WDC_KERNELS_H
+#define WDC_KERNELS_H
+
+#include <cstddef>
+#include "comparison.h"
+
+namespace wdc
+{
+namespace simd
+{
+
+// vectorized versions of make_threshold_factor and make_confined (comparison.h)
+// for arrays of doublets
+// the instruction set is picked at runtime (best_isa), scalar is always available
+enum isa_t { scalar, avx2, avx512 };
+
+isa_t best_isa();  // best instruction set supported by the cpu (cached)
+bool is_supported(const isa_t& isa);
+const char* get_name(const isa_t& isa);
+
+// approximation of pow(x, y) for x > 0 (used in the avx2 and avx512 kernels)
+// pow is evaluated as exp2(y * log2(x)) with polynomials
+// 	log2: x = 2^e * m with m in [sqrt(.5), sqrt(2)), ln(m) = 2 atanh(s), s = (m-1)/(m+1), series up to s^15
+// 	exp2: 2^z = 2^n * exp(f ln2), n = round(z), f in [-.5, .5], taylor series up to f^11
+// error bound: relative error below 1.e-13 for x in (0, 1] and y in [0, 2]
+// 	(which is the range of the S-curve U^(2(1-U)) of make_threshold_factor),
+//	results below 2^-1022 are flushed to zero (absolute error below 2.3e-308)
+double fast_pow(const double& x, const double& y);
+
+// factor[i] = make_threshold_factor(value[i], threshold_value[i], delta, sigma[i] > 0 ? lower : upper)
+// scalar kernel is exact, avx2 / avx512 kernels use fast_pow (see error bound above)
+void make_threshold_factor(const double* value, const double* threshold_value, const double* sigma,
+		const double& delta, double* factor, const std::size_t& n, const isa_t& isa = best_isa());
+
+// confined[i] = make_confined(value[i], lower_limit[i], upper_limit[i]) - exact for all instruction sets
+// confined may alias value
+void make_confined(const double* value, const double* lower_limit, const double* upper_limit,
+		double* confined, const std::size_t& n, const isa_t& isa = best_isa());
+
+}  // end namespace simd
+}  // end namespace wdc
+
+#endif
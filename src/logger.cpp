@@ -0,0 +1,232 @@
+#include "logger.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include "ringBuffer.h"
+#include "wdc_config.h"
+
+namespace wdc
+{
+namespace log
+{
+
+namespace
+{
+
+struct event_definition_t
+{
+	const char* format;
+	level_t level;
+	category_t category;
+};
+
+// same text as the former synchronous output
+const event_definition_t definitions[numberOfEvents] = {
+	{ "\t\t\tset system power rate\t\t{} - {s}", info, controller },  // set_system_powerrate
+	{ "\t\t\tset temperatures\theat exchanger: {}\t\tupwind aquifer: {}", debug, controller },  // set_temperatures
+	{ "\t\t\tset heat capacities\theat exchanger: {}\tupwind aquifer: {}", debug, controller },  // set_heat_capacities
+	{ "\t\t\tconfigure scheme 0 for {s}", info, controller },  // configure_scheme_0
+	{ "\t\t\tconfigure scheme {}\n\t\t\t\tfor {s}", info, controller },  // configure_scheme
+	{ "\t\t\twarm start", info, controller },  // warm_start
+	{ "\t\t\tset flow rate\t{}", debug, flowrate },  // set_flowrate
+	{ "\t\t\tadapt power rate - Storage: {} - System: {} - COP: {}", debug, powerrate },  // set_powerrate
+	{ "\t\tpowerrate to adapt", info, controller },  // powerrate_to_adapt
+	{ "\t\ttarget not achievable", info, controller },  // target_not_achievable
+	{ "\t\trates reduced", info, controller },  // rates_reduced
+	{ "\t\toperability: {}", debug, controller },  // operability
+	{ "\t\t\tstop adapting flow rate", info, flowrate },  // stop_adapting_flowrate
+	{ "\t\t\tsecant step", debug, flowrate },  // secant_step
+	{ "\t\t\tswitch off well", info, powerrate }  // switch_off_well
+};
+
+struct event_t
+{
+	std::chrono::steady_clock::rep time;  // order of recording across threads
+	unsigned long sequence;  // order of recording in thread (same time)
+	event_id_t id;
+	const char* text;
+	unsigned char numberOfValues;
+	double values[c_maximumNumberOfValues];
+};
+
+typedef RingBuffer<event_t> buffer_t;
+
+#if LOGGING == 1
+std::atomic<int> level(debug);
+#else
+std::atomic<int> level(off);
+#endif
+std::atomic<int> categories(all);
+std::atomic<bool> buffered(false);  // events recorded since last flush - written once per flush
+std::atomic<std::size_t> numberOfDroppedEvents(0);
+
+std::mutex registry_mutex;  // buffer registration and consumer side
+std::vector<std::shared_ptr<buffer_t> > buffers;  // shared with thread_local owner
+std::vector<event_t> pending;  // consumer side - reused
+std::ostream* sink = &std::cout;
+
+std::mutex thread_mutex;
+std::condition_variable thread_condition;
+std::thread thread;
+bool thread_running = false;
+struct stopper_t { ~stopper_t() { stop(); } } stopper;  // joins background thread and writes events at exit
+
+buffer_t& thread_buffer()
+{
+	thread_local std::shared_ptr<buffer_t> buffer;
+	if(!buffer)
+	{
+		buffer = std::make_shared<buffer_t>(c_bufferCapacity);
+		std::lock_guard<std::mutex> lock(registry_mutex);
+		buffers.push_back(buffer);
+	}
+	return *buffer;
+}
+
+void write(std::ostream& stream, const event_t& event)
+{
+	std::size_t value = 0;
+	for(const char* c = definitions[event.id].format; *c != '\0'; ++c)
+	{
+		if(c[0] == '{' && c[1] == '}')
+		{
+			if(value < event.numberOfValues)
+				stream << event.values[value++];
+			++c;
+		}
+		else if(c[0] == '{' && c[1] == 's' && c[2] == '}')
+		{
+			if(event.text != nullptr)
+				stream << event.text;
+			c += 2;
+		}
+		else
+			stream << *c;
+	}
+	stream << "\n";
+}
+
+unsigned long next_sequence()
+{	// per thread - no shared counter in hot path
+	thread_local unsigned long sequence = 0;
+	return sequence++;
+}
+
+void drain()
+{	// formats buffered events into sink
+	std::lock_guard<std::mutex> lock(registry_mutex);
+	buffered.store(false, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);  // pairs with fence in record - a concurrent
+					// event is popped below or its producer sees the flag cleared and sets it again
+	event_t event;
+	for(const std::shared_ptr<buffer_t>& buffer : buffers)
+		while(buffer->pop(event))
+			pending.push_back(event);
+	// buffers of finished threads are released once drained
+	buffers.erase(std::remove_if(buffers.begin(), buffers.end(),
+		[](const std::shared_ptr<buffer_t>& buffer) { return buffer.use_count() == 1 && buffer->empty(); }),
+		buffers.end());
+
+	if(pending.empty())
+		return;
+	std::sort(pending.begin(), pending.end(), [](const event_t& a, const event_t& b)
+		{ return a.time < b.time || (a.time == b.time && a.sequence < b.sequence); });
+	for(const event_t& _event : pending)
+		write(*sink, _event);
+	pending.clear();
+}
+
+}  // end anonymous namespace
+
+
+void set_level(const level_t& _level) { level.store(_level, std::memory_order_relaxed); }
+level_t get_level() { return static_cast<level_t>(level.load(std::memory_order_relaxed)); }
+void set_categories(const int& _categories) { categories.store(_categories, std::memory_order_relaxed); }
+int get_categories() { return categories.load(std::memory_order_relaxed); }
+
+void set_sink(std::ostream* _sink)
+{
+	drain();  // events recorded so far go to former sink
+	std::lock_guard<std::mutex> lock(registry_mutex);
+	sink = _sink;
+}
+
+bool is_enabled(const event_id_t& id)
+{
+	return definitions[id].level >= level.load(std::memory_order_relaxed) &&
+		(definitions[id].category & categories.load(std::memory_order_relaxed)) != 0;
+}
+
+void record(const event_id_t& id, const char* text, std::initializer_list<double> values)
+{
+	event_t event;
+	event.time = std::chrono::steady_clock::now().time_since_epoch().count();
+	event.sequence = next_sequence();
+	event.id = id;
+	event.text = text;
+	event.numberOfValues = static_cast<unsigned char>(std::min(values.size(), c_maximumNumberOfValues));
+	std::copy(values.begin(), values.begin() + event.numberOfValues, event.values);
+
+	if(!thread_buffer().push(event))
+	{
+		numberOfDroppedEvents.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	std::atomic_thread_fence(std::memory_order_seq_cst);  // push before flag load (see drain)
+	if(!buffered.load(std::memory_order_relaxed))
+		buffered.store(true, std::memory_order_relaxed);
+}
+
+void flush()
+{	// without lock if nothing to do (WDC_LOG calls it for each line)
+	if(level.load(std::memory_order_relaxed) == off || !buffered.load(std::memory_order_relaxed))
+		return;
+	drain();
+}
+
+void start(const int& interval_milliseconds)
+{
+	std::lock_guard<std::mutex> lock(thread_mutex);
+	if(thread_running)
+		return;
+	thread_running = true;
+	thread = std::thread([interval_milliseconds]()
+	{
+		std::unique_lock<std::mutex> lock(thread_mutex);
+		while(thread_running)
+		{
+			lock.unlock();
+			flush();
+			lock.lock();
+			thread_condition.wait_for(lock, std::chrono::milliseconds(interval_milliseconds),
+				[]() { return !thread_running; });
+		}
+	});
+}
+
+void stop()
+{
+	bool running;
+	{
+		std::lock_guard<std::mutex> lock(thread_mutex);
+		running = thread_running;
+		thread_running = false;
+	}
+	if(running)
+	{
+		thread_condition.notify_all();
+		thread.join();
+	}
+	drain();  // also without background thread (at exit)
+}
+
+std::size_t get_numberOfDroppedEvents() { return numberOfDroppedEvents.load(std::memory_order_relaxed); }
+
+} // end namespace log
+} // end namespace wdc
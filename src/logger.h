@@ -0,0 +1,61 @@
+#ifndef WDC_LOGGER_H
+#define WDC_LOGGER_H
+
+#include <ostream>
+#include <initializer_list>
+#include <cstddef>
+
+// binary event log for the hot path of the controller
+// WDC_EVENT records an event id and up to four doubles (and a static string) into a
+// lock-free buffer of the calling thread - formatting is done when the buffers are flushed
+// (log::flush or background thread started with log::start)
+// events are filtered at runtime by level and category
+// hosts without WDC_LOG (which flushes) call log::start or log::flush (e.g. per time step) - buffers hold
+// c_bufferCapacity events per thread, the rest is dropped - events still buffered are written at exit
+#define WDC_EVENT(id, ...) \
+	do { if(wdc::log::is_enabled(wdc::log::id)) wdc::log::record(wdc::log::id, nullptr, { __VA_ARGS__ }); } while(0)
+#define WDC_EVENT_TEXT(id, text, ...) \
+	do { if(wdc::log::is_enabled(wdc::log::id)) wdc::log::record(wdc::log::id, text, { __VA_ARGS__ }); } while(0)
+			// text must be a string literal (or have static storage duration)
+
+namespace wdc
+{
+namespace log
+{
+
+enum level_t { debug, info, warning, error, off };
+enum category_t { controller = 1, flowrate = 2, powerrate = 4, simulator = 8, all = 15 };
+
+// ids with format in logger.cpp - "{}" is replaced by the next value, "{s}" by the text
+enum event_id_t
+{
+	set_system_powerrate, set_temperatures, set_heat_capacities, configure_scheme_0, configure_scheme,
+	warm_start, set_flowrate, set_powerrate, powerrate_to_adapt, target_not_achievable, rates_reduced,
+	operability, stop_adapting_flowrate, secant_step, switch_off_well,
+	numberOfEvents
+};
+
+const std::size_t c_maximumNumberOfValues = 4;
+const std::size_t c_bufferCapacity = 1 << 13;  // events per thread, new events are dropped if full
+
+void set_level(const level_t& level);  // default: debug if LOGGING is 1, off else
+level_t get_level();
+void set_categories(const int& categories);  // bit mask of category_t (default all)
+int get_categories();
+void set_sink(std::ostream* sink);  // default std::cout
+
+bool is_enabled(const event_id_t& id);
+void record(const event_id_t& id, const char* text, std::initializer_list<double> values);
+			// never blocks - first call in a thread allocates its buffer
+
+void flush();  // formats buffered events of all threads into sink (in order of recording time)
+		// the sink itself is not flushed - returns at once if level is off or nothing was recorded since
+		// last flush (events recorded while flushing may be written by the next one, set_sink and stop write all)
+void start(const int& interval_milliseconds = 100);  // flush from background thread
+void stop();  // stops background thread (if started) and writes all buffered events
+std::size_t get_numberOfDroppedEvents();
+
+} // end namespace log
+} // end namespace wdc
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef WDC_RING_BUFFER_H
+#define WDC_RING_BUFFER_H
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+namespace wdc
+{
+
+// lock-free single producer / single consumer queue of fixed capacity
+// push and pop never block or allocate (storage is allocated in constructor)
+// capacity is rounded up to a power of two
+template<typename T>
+class RingBuffer
+{
+	std::vector<T> slots;
+	std::size_t mask;
+	alignas(64) std::atomic<std::size_t> head;  // next slot to pop - written by consumer
+	alignas(64) std::atomic<std::size_t> tail;  // next slot to push - written by producer
+public:
+	explicit RingBuffer(const std::size_t& _capacity) : head(0), tail(0)
+	{
+		std::size_t capacity = 1;
+		while(capacity < _capacity)
+			capacity <<= 1;
+		slots.resize(capacity);
+		mask = capacity - 1;
+	}
+	RingBuffer(const RingBuffer&) = delete;
+	RingBuffer& operator=(const RingBuffer&) = delete;
+
+	std::size_t capacity() const { return slots.size(); }
+	std::size_t size() const  // approximate if called concurrently
+	{ return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire); }
+	bool empty() const { return size() == 0; }
+
+	bool push(const T& value)  // producer - false if full
+	{
+		const std::size_t _tail = tail.load(std::memory_order_relaxed);
+		if(_tail - head.load(std::memory_order_acquire) == slots.size())
+			return false;
+		slots[_tail & mask] = value;
+		tail.store(_tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool pop(T& value)  // consumer - false if empty
+	{
+		const std::size_t _head = head.load(std::memory_order_relaxed);
+		if(_head == tail.load(std::memory_order_acquire))
+			return false;
+		value = slots[_head & mask];
+		head.store(_head + 1, std::memory_order_release);
+		return true;
+	}
+};
+
+} // end namespace wdc
+
+#endif
@@ -0,0 +1,76 @@
+#include "statistics.h"
+#include <algorithm>
+#include <numeric>
+
+namespace wdc
+{
+
+static const char* state_names[statistics_t::numberOfStates] =
+	{ "powerrate_to_adapt", "on_demand", "target_not_achievable", "rates_reduced" };
+
+void statistics_t::clear()
+{
+	timeSteps = iterations = iterations_timeStep = iterations_timeStep_max = 0;
+	std::fill(iterations_state, iterations_state + numberOfStates, 0);
+	std::fill(&transitions[0][0], &transitions[0][0] + numberOfStates * numberOfStates, 0);
+	flowrate_adaptions = powerrate_adaptions = 0;
+	flowrate_not_converged = powerrate_not_converged = 0;
+}
+
+statistics_t& statistics_t::operator+=(const statistics_t& other)
+{
+	timeSteps += other.timeSteps;
+	iterations += other.iterations;
+	iterations_timeStep = std::max(iterations_timeStep, other.iterations_timeStep);
+	iterations_timeStep_max = std::max(iterations_timeStep_max, other.iterations_timeStep_max);
+	for(int i=0; i<numberOfStates; ++i)
+	{
+		iterations_state[i] += other.iterations_state[i];
+		for(int j=0; j<numberOfStates; ++j)
+			transitions[i][j] += other.transitions[i][j];
+	}
+	flowrate_adaptions += other.flowrate_adaptions;
+	powerrate_adaptions += other.powerrate_adaptions;
+	flowrate_not_converged += other.flowrate_not_converged;
+	powerrate_not_converged += other.powerrate_not_converged;
+	return *this;
+}
+
+std::ostream& operator<<(std::ostream& stream, const statistics_t& statistics)
+{
+	stream << "time steps: " << statistics.timeSteps << " - iterations: " << statistics.iterations
+		<< " (max per time step: " << statistics.iterations_timeStep_max << ")\n";
+	stream << "\titerations in state:";
+	for(int i=0; i<statistics_t::numberOfStates; ++i)
+		stream << " " << state_names[i] << " " << statistics.iterations_state[i];
+	stream << "\n\ttransitions:";
+	for(int i=0; i<statistics_t::numberOfStates; ++i)
+		for(int j=0; j<statistics_t::numberOfStates; ++j)
+			if(statistics.transitions[i][j] > 0)
+				stream << " " << state_names[i] << "->" << state_names[j] << " " << statistics.transitions[i][j];
+	stream << "\n\tadaptions: flowrate " << statistics.flowrate_adaptions << " - powerrate " << statistics.powerrate_adaptions;
+	stream << "\n\tnot converged: flowrate " << statistics.flowrate_not_converged
+		<< " - powerrate " << statistics.powerrate_not_converged << "\n";
+	return stream;
+}
+
+void write_statistics(std::ostream& stream, const std::vector<statistics_t>& statistics,
+		const std::size_t& numberOfTopDoublets)
+{
+	statistics_t sum;
+	for(const statistics_t& doublet : statistics)
+		sum += doublet;
+	stream << "doublets: " << statistics.size() << " - " << sum;
+
+	std::vector<std::size_t> indices(statistics.size());
+	std::iota(indices.begin(), indices.end(), 0);
+	const std::size_t n = std::min(numberOfTopDoublets, indices.size());
+	std::partial_sort(indices.begin(), indices.begin() + n, indices.end(),
+		[&statistics](const std::size_t& a, const std::size_t& b)
+		{ return statistics[a].iterations > statistics[b].iterations; });
+
+	for(std::size_t i=0; i<n; ++i)
+		stream << "doublet " << indices[i] << " - " << statistics[indices[i]];
+}
+
+} // end namespace wdc
@@ -0,0 +1,41 @@
+#ifndef WDC_STATISTICS_H
+#define WDC_STATISTICS_H
+
+#include <ostream>
+#include <vector>
+#include <cstddef>
+
+namespace wdc
+{
+
+// iteration and convergence counters of a WellDoubletControl instance
+// (collected if switched on with set_statistics_enabled - otherwise one branch per call)
+// states are indexed with WellDoubletControl::storage_state_t
+struct statistics_t
+{
+	enum { numberOfStates = 4 };
+
+	long timeSteps;  // calls of configure
+	long iterations;  // calls of evaluate_simulation_result
+	long iterations_timeStep;  // in current (or last) time step
+	long iterations_timeStep_max;
+	long iterations_state[numberOfStates];  // iterations which ended in state
+	long transitions[numberOfStates][numberOfStates];  // [from][to] in evaluate_simulation_result
+	long flowrate_adaptions, powerrate_adaptions;  // calls of adapt_flowrate, adapt_powerrate
+	long flowrate_not_converged, powerrate_not_converged;  // converged() returned false because of
+
+	statistics_t() { clear(); }
+	void clear();
+	statistics_t& operator+=(const statistics_t& other);  // iterations_timeStep(_max) take maximum
+};
+
+std::ostream& operator<<(std::ostream& stream, const statistics_t& statistics);
+
+// writes sum over all doublets and the doublets with most iterations
+// (index is position in vector)
+void write_statistics(std::ostream& stream, const std::vector<statistics_t>& statistics,
+		const std::size_t& numberOfTopDoublets = 10);
+
+} // end namespace wdc
+
+#endif
@@ -0,0 +1,234 @@
+#include <cstring>
+#include <cstddef>  // for offsetof
+#include "trace.h"
+
+namespace wdc
+{
+
+namespace
+{
+
+const char c_magic[4] = { 'W', 'D', 'C', 'T' };
+const std::uint32_t c_byteOrder = 0x01020304;
+
+std::size_t get_bodySize(const std::uint32_t& event)
+{
+	switch(event)
+	{
+		case trace_state: return sizeof(checkpoint_t);
+		case trace_configure: return sizeof(trace_configure_t);
+		case trace_evaluate: return sizeof(trace_evaluate_t);
+		default: return 0;
+	}
+}
+
+trace_result_t make_result(const WellDoubletControl::result_t& result, const bool& converged)
+{
+	return { result.Q_H, result.Q_W, result.Q_H_sys, result.T_HE, result.T_UA,
+		static_cast<std::int32_t>(result.storage_state), converged };
+}
+
+bool equal(const trace_result_t& recorded, const WellDoubletControl::result_t& result)
+{	// bitwise (NaN included)
+	const trace_result_t replayed = make_result(result, false);
+	return std::memcmp(&recorded, &replayed, offsetof(trace_result_t, converged)) == 0;
+}
+
+}  // end anonymous namespace
+
+
+bool TraceRecorder::open(const std::string& path)
+{
+	close();
+	stream.open(path, std::ios::binary | std::ios::trunc);
+	if(!stream)
+		return false;
+	trace_header_t header;
+	std::memcpy(header.magic, c_magic, sizeof(c_magic));
+	header.version = c_traceVersion;
+	header.byteOrder = c_byteOrder;
+	header.checkpointSize = sizeof(checkpoint_t);
+	stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	buffer.reserve(c_bufferCapacity);
+	numberOfRecords = 0;
+	return true;
+}
+
+void TraceRecorder::close()
+{
+	if(!stream.is_open())
+		return;
+	stream.write(buffer.data(), buffer.size());
+	buffer.clear();
+	stream.close();
+}
+
+void TraceRecorder::append(const trace_event_t& event, const std::uint32_t& controller, const void* body,
+		const std::size_t& size)
+{
+	if(!stream.is_open())
+		return;
+	if(buffer.size() + sizeof(trace_record_header_t) + size > c_bufferCapacity)
+	{
+		stream.write(buffer.data(), buffer.size());
+		buffer.clear();
+	}
+	const trace_record_header_t header = { static_cast<std::uint32_t>(event), controller };
+	const char* _header = reinterpret_cast<const char*>(&header);
+	buffer.insert(buffer.end(), _header, _header + sizeof(header));
+	buffer.insert(buffer.end(), static_cast<const char*>(body), static_cast<const char*>(body) + size);
+	++numberOfRecords;
+}
+
+void TraceRecorder::record_state(const std::uint32_t& controller, const WellDoubletControl& wellDoubletControl)
+{
+	checkpoint_t state;
+	wellDoubletControl.save_state(state);
+	append(trace_state, controller, &state, sizeof(state));
+}
+
+void TraceRecorder::record_configure(const std::uint32_t& controller, const double& Q_H_sys,
+	const double& value_target, const double& value_threshold,
+	const WellDoubletControl::balancing_properties_t& balancing_properties,
+	const WellDoubletControl::result_t& result)
+{
+	const trace_configure_t body = { Q_H_sys, value_target, value_threshold,
+		balancing_properties.T_HE, balancing_properties.T_UA,
+		balancing_properties.volumetricHeatCapacity_HE, balancing_properties.volumetricHeatCapacity_UA,
+		make_result(result, false) };
+	append(trace_configure, controller, &body, sizeof(body));
+}
+
+void TraceRecorder::record_evaluate(const std::uint32_t& controller,
+	const WellDoubletControl::balancing_properties_t& balancing_properties,
+	const WellDoubletControl::result_t& result, const bool& converged)
+{
+	const trace_evaluate_t body = { balancing_properties.T_HE, balancing_properties.T_UA,
+		balancing_properties.volumetricHeatCapacity_HE, balancing_properties.volumetricHeatCapacity_UA,
+		make_result(result, converged) };
+	append(trace_evaluate, controller, &body, sizeof(body));
+}
+
+
+void TraceReplay::clear()
+{
+	for(WellDoubletControl* controller : controllers)
+		delete controller;
+	controllers.clear();
+	events.clear();
+	buffer.clear();
+	numberOfIds = numberOfEvaluations = 0;
+}
+
+bool TraceReplay::load(const std::string& path)
+{
+	std::ifstream stream(path, std::ios::binary | std::ios::ate);
+	if(!stream)
+		return false;
+	std::vector<char> data(static_cast<std::size_t>(stream.tellg()));
+	stream.seekg(0);
+	stream.read(data.data(), data.size());
+	return stream && assign(data.data(), data.size());
+}
+
+bool TraceReplay::assign(const void* data, const std::size_t& size)
+{
+	clear();
+	trace_header_t header;
+	if(size < sizeof(header))
+		return false;
+	std::memcpy(&header, data, sizeof(header));
+	if(std::memcmp(header.magic, c_magic, sizeof(c_magic)) != 0 || header.version != c_traceVersion ||
+			header.byteOrder != c_byteOrder || header.checkpointSize != sizeof(checkpoint_t))
+		return false;
+	buffer.assign(static_cast<const char*>(data), static_cast<const char*>(data) + size);
+
+	std::vector<std::size_t> instances;  // current controller of id (size(): none yet)
+	std::size_t offset = sizeof(header);
+	while(offset < size)
+	{
+		trace_record_header_t record;
+		if(offset + sizeof(record) > size)
+			break;
+		std::memcpy(&record, buffer.data() + offset, sizeof(record));
+		offset += sizeof(record);
+		const std::size_t bodySize = get_bodySize(record.event);
+		if(bodySize == 0 || offset + bodySize > size)
+			break;
+		if(record.controller >= instances.size())
+			instances.resize(record.controller + 1, std::size_t(-1));
+		std::size_t& instance = instances[record.controller];
+		if(record.event == trace_state)
+		{	// controllers are created here - run only restores states
+			checkpoint_t state;
+			std::memcpy(&state, buffer.data() + offset, sizeof(state));
+			if(state.scheme_ID < 0 || state.scheme_ID > 2)
+				break;
+			if(instance == std::size_t(-1) || controllers[instance]->get_scheme_ID() != state.scheme_ID)
+			{
+				instance = controllers.size();
+				controllers.push_back(WellDoubletControl::create_wellDoubletControl(state.scheme_ID,
+					state.well_shutdown_temperature_range,
+					{ state.accuracy_temperature, state.accuracy_powerrate, state.accuracy_flowrate }));
+			}
+		}
+		else if(instance == std::size_t(-1))
+			break;  // no state before
+		numberOfEvaluations += (record.event == trace_evaluate);
+		events.push_back({ static_cast<trace_event_t>(record.event), instance, offset });
+		offset += bodySize;
+	}
+	numberOfIds = instances.size();
+	if(offset != size)
+	{
+		clear();
+		return false;
+	}
+	return true;
+}
+
+std::size_t TraceReplay::run(const bool& check)
+{
+	std::size_t numberOfMismatches = 0;
+	for(const event_t& event : events)
+	{
+		WellDoubletControl* controller = controllers[event.controller];
+		const char* body = buffer.data() + event.offset;
+		switch(event.event)
+		{
+			case trace_state:
+			{
+				checkpoint_t state;
+				std::memcpy(&state, body, sizeof(state));
+				controller->restore_state(state);
+				break;
+			}
+			case trace_configure:
+			{
+				trace_configure_t configure;
+				std::memcpy(&configure, body, sizeof(configure));
+				controller->configure(configure.Q_H_sys, configure.value_target, configure.value_threshold,
+					{ configure.T_HE, configure.T_UA,
+					configure.volumetricHeatCapacity_HE, configure.volumetricHeatCapacity_UA });
+				if(check && !equal(configure.result, controller->get_result()))
+					++numberOfMismatches;
+				break;
+			}
+			case trace_evaluate:
+			{
+				trace_evaluate_t evaluate;
+				std::memcpy(&evaluate, body, sizeof(evaluate));
+				controller->evaluate_simulation_result({ evaluate.T_HE, evaluate.T_UA,
+					evaluate.volumetricHeatCapacity_HE, evaluate.volumetricHeatCapacity_UA });
+				if(check && (!equal(evaluate.result, controller->get_result()) ||
+						(evaluate.result.converged != 0) !=
+						(controller->flowrate_converged() && controller->powerrate_converged())))
+					++numberOfMismatches;
+				break;
+			}
+		}
+	}
+	return numberOfMismatches;
+}
+
+} // end namespace wdc
@@ -0,0 +1,126 @@
+#ifndef WDC_TRACE_H
+#define WDC_TRACE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include "wellDoubletControl.h"
+#include "checkpoint.h"
+
+namespace wdc
+{
+
+// binary trace of the coupling iterations of controllers (to replay them without simulator)
+// a recorder is attached to a controller with WellDoubletControl::set_traceRecorder
+// layout: trace_header_t followed by records (trace_record_header_t and a body of its type)
+// 	state: checkpoint_t of the controller before each configure (options, resets and
+// 		heat pump between time steps are captured with it)
+// 	configure: inputs of configure and the result
+// 	evaluate: balancing properties of evaluate_simulation_result, the result and converged()
+// records are written in the byte order of the host as checkpoints
+const std::uint32_t c_traceVersion = 1;
+
+struct trace_header_t
+{
+	char magic[4];  // "WDCT"
+	std::uint32_t version;
+	std::uint32_t byteOrder;  // 0x01020304 as written by host
+	std::uint32_t checkpointSize;  // sizeof(checkpoint_t) of state records
+};
+
+enum trace_event_t { trace_state = 1, trace_configure = 2, trace_evaluate = 3 };
+
+struct trace_record_header_t
+{
+	std::uint32_t event;  // trace_event_t
+	std::uint32_t controller;  // id given to set_traceRecorder
+};
+
+struct trace_result_t
+{
+	double Q_H, Q_W, Q_H_sys, T_HE, T_UA;
+	std::int32_t storage_state;
+	std::int32_t converged;  // evaluate only
+};
+
+struct trace_configure_t
+{
+	double Q_H_sys, value_target, value_threshold;
+	double T_HE, T_UA, volumetricHeatCapacity_HE, volumetricHeatCapacity_UA;
+	trace_result_t result;
+};
+
+struct trace_evaluate_t
+{
+	double T_HE, T_UA, volumetricHeatCapacity_HE, volumetricHeatCapacity_UA;
+	trace_result_t result;
+};
+
+
+// records into a buffer which is written when full and at close
+// not thread-safe - use one recorder per thread (or simulator)
+class TraceRecorder
+{
+	std::ofstream stream;
+	std::vector<char> buffer;
+	std::size_t numberOfRecords;
+	static const std::size_t c_bufferCapacity = 1 << 20;  // bytes
+
+	void append(const trace_event_t& event, const std::uint32_t& controller, const void* body,
+			const std::size_t& size);
+public:
+	TraceRecorder() : numberOfRecords(0) {}
+	~TraceRecorder() { close(); }
+	TraceRecorder(const TraceRecorder&) = delete;
+	TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+	bool open(const std::string& path);  // truncates
+	void close();
+	bool is_open() const { return stream.is_open(); }
+	std::size_t get_numberOfRecords() const { return numberOfRecords; }
+
+	void record_state(const std::uint32_t& controller, const WellDoubletControl& wellDoubletControl);
+	void record_configure(const std::uint32_t& controller, const double& Q_H_sys,
+		const double& value_target, const double& value_threshold,
+		const WellDoubletControl::balancing_properties_t& balancing_properties,
+		const WellDoubletControl::result_t& result);
+	void record_evaluate(const std::uint32_t& controller,
+		const WellDoubletControl::balancing_properties_t& balancing_properties,
+		const WellDoubletControl::result_t& result, const bool& converged);
+};
+
+
+// feeds a trace into controllers (one per id, created from the state records)
+// and compares their results with the recorded ones
+class TraceReplay
+{
+	struct event_t { trace_event_t event; std::size_t controller; std::size_t offset; };  // of body
+	std::vector<char> buffer;
+	std::vector<event_t> events;
+	std::vector<WellDoubletControl*> controllers;  // new instance if an id changes scheme
+	std::size_t numberOfIds, numberOfEvaluations;
+
+	void clear();
+public:
+	TraceReplay() : numberOfIds(0), numberOfEvaluations(0) {}
+	~TraceReplay() { clear(); }
+	TraceReplay(const TraceReplay&) = delete;
+	TraceReplay& operator=(const TraceReplay&) = delete;
+
+	bool load(const std::string& path);  // one read
+	bool assign(const void* data, const std::size_t& size);  // copies - false if not a valid trace
+	std::size_t get_numberOfEvents() const { return events.size(); }
+	std::size_t get_numberOfEvaluations() const { return numberOfEvaluations; }
+	std::size_t get_numberOfControllers() const { return numberOfIds; }  // ids in trace
+
+	std::size_t run(const bool& check = true);
+			// replays all events - returns number of results which differ from the trace
+			// (bitwise, for check only)
+};
+
+} // end namespace wdc
+
+#endif
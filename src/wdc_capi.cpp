@@ -0,0 +1,106 @@
+#include <new>
+#include "wdc_capi.h"
+#include "wellDoubletControlBatch.h"
+
+struct wdc_handle
+{
+	wdc::WellDoubletControlBatch batch;
+	wdc_handle(const int& scheme, const std::size_t& n, const double& well_shutdown_temperature_range,
+			const wdc::WellDoubletControl::accuracies_t& accuracies) :
+		batch(scheme, n, well_shutdown_temperature_range, accuracies) {}
+};
+
+
+int wdc_api_version(void)
+{
+	return WDC_API_VERSION;
+}
+
+wdc_handle* wdc_create(int scheme, size_t n, double well_shutdown_temperature_range,
+	double accuracy_temperature, double accuracy_powerrate, double accuracy_flowrate, int* error)
+{
+	int status = WDC_OK;
+	wdc_handle* handle = nullptr;
+	if(scheme < 0 || scheme > 2)
+		status = WDC_ERROR_SCHEME;  // batch would abort
+	else
+	{
+		try
+		{
+			handle = new wdc_handle(scheme, n, well_shutdown_temperature_range,
+				{ accuracy_temperature, accuracy_powerrate, accuracy_flowrate });
+		}
+		catch(const std::bad_alloc&)
+		{
+			status = WDC_ERROR_MEMORY;
+		}
+	}
+	if(error != nullptr)
+		*error = status;
+	return handle;
+}
+
+void wdc_destroy(wdc_handle* handle)
+{
+	delete handle;
+}
+
+size_t wdc_size(const wdc_handle* handle)
+{
+	return (handle != nullptr) ? handle->batch.size() : 0;
+}
+
+int wdc_set_heatPump(wdc_handle* handle, size_t i, int type, double T_sink, double eta)
+{
+	if(handle == nullptr || i >= handle->batch.size() || type < 0 || type > 1)
+		return WDC_ERROR_ARGUMENT;
+	handle->batch.set_heatPump(i, type, T_sink, eta);
+	return WDC_OK;
+}
+
+int wdc_configure_batch(wdc_handle* handle, const double* Q_H,
+	const double* value_target, const double* value_threshold,
+	const double* T_HE, const double* T_UA,
+	const double* volumetricHeatCapacity_HE, const double* volumetricHeatCapacity_UA)
+{
+	if(handle == nullptr || Q_H == nullptr || value_target == nullptr || value_threshold == nullptr ||
+			T_HE == nullptr || T_UA == nullptr ||
+			volumetricHeatCapacity_HE == nullptr || volumetricHeatCapacity_UA == nullptr)
+		return WDC_ERROR_ARGUMENT;
+	handle->batch.configure(Q_H, value_target, value_threshold,
+		{ T_HE, T_UA, volumetricHeatCapacity_HE, volumetricHeatCapacity_UA });
+	return WDC_OK;
+}
+
+int wdc_evaluate_batch(wdc_handle* handle,
+	const double* T_HE, const double* T_UA,
+	const double* volumetricHeatCapacity_HE, const double* volumetricHeatCapacity_UA, int* converged)
+{
+	if(handle == nullptr || T_HE == nullptr || T_UA == nullptr ||
+			volumetricHeatCapacity_HE == nullptr || volumetricHeatCapacity_UA == nullptr)
+		return WDC_ERROR_ARGUMENT;
+	handle->batch.evaluate_simulation_result({ T_HE, T_UA, volumetricHeatCapacity_HE, volumetricHeatCapacity_UA });
+	if(converged != nullptr)
+		*converged = handle->batch.converged() ? 1 : 0;
+	return WDC_OK;
+}
+
+int wdc_get_results(const wdc_handle* handle, double* Q_H, double* Q_W, double* Q_H_sys, int* storage_state)
+{
+	if(handle == nullptr)
+		return WDC_ERROR_ARGUMENT;
+	const wdc::WellDoubletControlBatch& batch = handle->batch;
+	const std::size_t n = batch.size();
+	for(std::size_t i=0; i<n; ++i)
+	{
+		if(Q_H != nullptr)
+			Q_H[i] = batch.get_powerrates()[i];
+		if(Q_W != nullptr)
+			Q_W[i] = batch.get_flowrates()[i];
+		if(Q_H_sys != nullptr)
+			Q_H_sys[i] = batch.get_system_powerrates()[i];
+		if(storage_state != nullptr)
+			storage_state[i] = static_cast<int>(batch.get_storage_states()[i]);
+	}
+	return WDC_OK;
+}
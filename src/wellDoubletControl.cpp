@@ -7,16 +7,51 @@
 #include <cfloat>  // for DBL_MIN
 #include <algorithm>
 #include "wellDoubletControl.h"
+#include "trace.h"
 
 namespace wdc
 {
 void WellDoubletControl::set_heatPump(const int& _type, const double& T_sink, const double& eta)
 {
 	if(_type == 1)
-	{
-		delete heatPump;
-		heatPump = new CarnotHeatPump(T_sink, eta);
-	}
+		heatPump.set(CarnotHeatPump(T_sink, eta));
+	else if(_type == 2 && heatPumpTable)
+		heatPump.set(TabulatedHeatPump(heatPumpTable.get(), T_sink));
+	else
+		heatPump.set(NoHeatPump());
+}
+
+void WellDoubletControl::set_heatPumpTable(const std::shared_ptr<const wdc::COPTable>& table)
+{	// heat pump must not point to a released table
+	heatPumpTable = table;
+	if(heatPump.get_type() == HeatPumpVariant::tabulated)
+		set_heatPump(2, heatPump.get_tabulated().get_T_sink(), -1.);
+}
+
+void WellDoubletControl::reset()
+{
+	result = { 0., 0., 0., 0., 0., on_demand };
+	Q_H_sys_target = 0.;
+	Q_H_sys_old = 0.;
+	Q_W_old = 0.;
+	value_target = 0.;
+	value_threshold = 0.;
+	operationType = storing;
+	flowrate_adaption_factor = c_flowrate_adaption_factor;
+	deltaTsign_stored = 0.;
+	iterate_previous.set = iterate_below.set = iterate_above.set = false;
+	powerrate_previous.set = false;
+	powerrate_sensitivity = 0.;
+	previous_timeStep = false;
+	Q_H_demand = 0.;
+	heatPump.reset();
+}
+
+void WellDoubletControl::reset(const double& _well_shutdown_temperature_range, const accuracies_t& _accuracies)
+{
+	well_shutdown_temperature_range = _well_shutdown_temperature_range;
+	accuracies = _accuracies;
+	reset();
 }
 
 
@@ -31,22 +66,28 @@ void WellDoubletControl::configure(
 	const double& _value_target, const double& _value_threshold,
 	const balancing_properties_t& balancing_properties)
 {
+	if(traceRecorder != nullptr)
+		traceRecorder->record_state(trace_id, *this);
+	const result_t previous = result;
+	const double previous_flowrate_adaption_factor = flowrate_adaption_factor;
+	const bool warm = warm_start && previous_timeStep && ((_Q_H_sys > 0.) == (operationType == storing));
+
 	set_balancing_properties(balancing_properties);
 
 	Q_H_sys_target = _Q_H_sys;  // just for output;
 	result.Q_H_sys = _Q_H_sys;
 	if(_Q_H_sys > 0.)
 	{
-		WDC_LOG("\t\t\tset system power rate\t\t" <<_Q_H_sys << " - storing");
+		WDC_EVENT_TEXT(set_system_powerrate, "storing", _Q_H_sys);
 		operationType = storing;
 		result.Q_H = _Q_H_sys;
 		result.Q_W = accuracies.flowrate;
 	}
 	else
 	{
-		WDC_LOG("\t\t\tset system power rate\t\t" << _Q_H_sys << " - extracting");
+		WDC_EVENT_TEXT(set_system_powerrate, "extracting", _Q_H_sys);
 		operationType = extracting;
-        	result.Q_H = heatPump->calculate_heat_source(_Q_H_sys, result.T_UA, result.T_HE);
+        	result.Q_H = heatPump.calculate_heat_source(_Q_H_sys, result.T_UA, result.T_HE);
 		result.Q_W = -accuracies.flowrate;
 	}
 
@@ -55,11 +96,50 @@ void WellDoubletControl::configure(
 
 	value_target = _value_target;
 	value_threshold = _value_threshold;
+	Q_H_demand = result.Q_H;
+	powerrate_previous.set = false;
+	if(!warm)
+		powerrate_sensitivity = 0.;  // else taken from last time step
 
 	// the scheme-dependent stuff
 	configure_scheme();  // iterationState & comparison functions 
 			//for temperature target (A, C), temperature constraint (B)
 	estimate_flowrate();  // an estimation for scheme A and a target for scheme B
+
+	if(warm && result.storage_state == on_demand)  // not if rates are reduced
+	{
+		WDC_EVENT(warm_start);
+		// keep learned damping but relax it by one step so that it does not decay over time steps
+		flowrate_adaption_factor = std::min(previous_flowrate_adaption_factor / c_flowrate_adaption_factor,
+						c_flowrate_adaption_factor);
+		warm_start_rates(previous);
+	}
+	previous_timeStep = true;
+
+	if(statistics_enabled)
+	{
+		++statistics.timeSteps;
+		statistics.iterations_timeStep = 0;
+	}
+	if(traceRecorder != nullptr)
+		traceRecorder->record_configure(trace_id, _Q_H_sys, _value_target, _value_threshold,
+			balancing_properties, result);
+}
+
+void WellDoubletControl::record_evaluate(const balancing_properties_t& balancing_properties) const
+{	// convergence without counting in statistics
+	traceRecorder->record_evaluate(trace_id, balancing_properties, result,
+		flowrate_converged() && powerrate_converged());
+}
+
+void WellDoubletControl::count_iteration(const storage_state_t& state_before)
+{
+	++statistics.iterations;
+	statistics.iterations_timeStep_max = std::max(statistics.iterations_timeStep_max,
+						++statistics.iterations_timeStep);
+	++statistics.iterations_state[result.storage_state];
+	if(result.storage_state != state_before)
+		++statistics.transitions[state_before][result.storage_state];
 }
 
 void WellDoubletControl::set_balancing_properties(const balancing_properties_t& balancing_properties)
@@ -72,10 +152,41 @@ void WellDoubletControl::set_balancing_properties(const balancing_properties_t&
 	result.T_UA = balancing_properties.T_UA;  // cold well
 	volumetricHeatCapacity_HE = balancing_properties.volumetricHeatCapacity_HE;  // warm well
 	volumetricHeatCapacity_UA = balancing_properties.volumetricHeatCapacity_UA;  // cold well
-	WDC_LOG("\t\t\tset temperatures\theat exchanger: " <<
-			balancing_properties.T_HE << "\t\tupwind aquifer: " << balancing_properties.T_UA);
-	WDC_LOG("\t\t\tset heat capacities\theat exchanger: " << balancing_properties.volumetricHeatCapacity_HE
-					<< "\tupwind aquifer: " << balancing_properties.volumetricHeatCapacity_UA);
+	WDC_EVENT(set_temperatures, balancing_properties.T_HE, balancing_properties.T_UA);
+	WDC_EVENT(set_heat_capacities, balancing_properties.volumetricHeatCapacity_HE,
+					balancing_properties.volumetricHeatCapacity_UA);
+}
+
+double WellDoubletControl::newton_powerrate(const double& residual, const double& fixedGain_powerrate)
+{
+	if(powerrate_adaption == fixed_gain)
+		return fixedGain_powerrate;
+
+	const double Q_H = result.Q_H;
+	if(powerrate_previous.set && fabs(Q_H - powerrate_previous.Q_H) > DBL_EPSILON * fabs(Q_H))
+	{	// secant (1D Broyden) update - keep last estimate if it has the wrong sign
+		const double sensitivity = (residual - powerrate_previous.residual) / (Q_H - powerrate_previous.Q_H);
+		if(sensitivity > 0.)
+			powerrate_sensitivity = sensitivity;
+	}
+	powerrate_previous = { Q_H, residual, true };
+
+	const double fixedGain_step = fixedGain_powerrate - Q_H;
+	if(powerrate_sensitivity <= 0.)
+	{	// initial estimate from fixed gain step
+		if(fabs(residual) < DBL_MIN || fabs(fixedGain_step) < DBL_MIN)
+			return fixedGain_powerrate;
+		powerrate_sensitivity = -residual / fixedGain_step;
+		if(powerrate_sensitivity <= 0.)
+		{
+			powerrate_sensitivity = 0.;
+			return fixedGain_powerrate;
+		}
+	}
+
+	// safeguard: limit step
+	const double limit = c_powerrate_newton_step_limit * fabs(fixedGain_step);
+	return make_confined(Q_H - residual / powerrate_sensitivity, Q_H - limit, Q_H + limit);
 }
 
 WellDoubletControl* WellDoubletControl::create_wellDoubletControl(
@@ -97,404 +208,485 @@ WellDoubletControl* WellDoubletControl::create_wellDoubletControl(
 }
 
 
-void WellScheme_0::configure_scheme()
+template<int SchemeID>
+void WellSchemeDispatch<SchemeID>::configure_scheme()
 {
 	if (operationType == storing)
-	{
-		WDC_LOG("\t\t\tconfigure scheme 0 for storing");
-		beyond.configure(new wdc::Greater(0.));
-	}
+		WellScheme<SchemeID, Storing>::configure_scheme(*this);
 	else
-	{
-		WDC_LOG("\t\t\tconfigure scheme 0 for extracting");
-		beyond.configure(new wdc::Smaller(0.));
-	}
+		WellScheme<SchemeID, Extracting>::configure_scheme(*this);
 }
 
-void WellScheme_0::evaluate_simulation_result(const balancing_properties_t& balancing_properties)
+template<int SchemeID>
+void WellSchemeDispatch<SchemeID>::estimate_flowrate()
 {
-	set_balancing_properties(balancing_properties);
-	Q_H_sys_old = get_result().Q_H_sys;
+	if (operationType == storing)
+		WellScheme<SchemeID, Storing>::estimate_flowrate(*this);
+	else
+		WellScheme<SchemeID, Extracting>::estimate_flowrate(*this);
+}
+
+template<int SchemeID>
+void WellSchemeDispatch<SchemeID>::warm_start_rates(const result_t& previous)
+{
+	if (operationType == storing)
+		WellScheme<SchemeID, Storing>::warm_start_rates(*this, previous);
+	else
+		WellScheme<SchemeID, Extracting>::warm_start_rates(*this, previous);
+}
+
+template<int SchemeID>
+void WellSchemeDispatch<SchemeID>::evaluate_simulation_result(const balancing_properties_t& balancing_properties)
+{
+	const storage_state_t state_before = get_result().storage_state;
+	if (operationType == storing)
+		WellScheme<SchemeID, Storing>::evaluate_simulation_result(*this, balancing_properties);
+	else
+		WellScheme<SchemeID, Extracting>::evaluate_simulation_result(*this, balancing_properties);
+	if (statistics_enabled)
+		count_iteration(state_before);
+	if (traceRecorder != nullptr)
+		record_evaluate(balancing_properties);
+}
+
+template<int SchemeID>
+bool WellSchemeDispatch<SchemeID>::flowrate_converged() const
+{
+	return (operationType == storing) ?
+		WellScheme<SchemeID, Storing>::flowrate_converged(*this) :
+		WellScheme<SchemeID, Extracting>::flowrate_converged(*this);
+}
+
+
+template<typename Direction>
+void WellScheme<0, Direction>::configure_scheme(WellDoubletControl& wdc)
+{
+	WDC_EVENT_TEXT(configure_scheme_0, Direction::name());
+}
 
-	const double Q_H = (get_result().Q_H_sys > 0.) ? get_result().Q_H_sys : 
-		heatPump->calculate_heat_source(get_result().Q_H_sys, balancing_properties.T_UA, balancing_properties.T_HE);  // !!! call to update COP
+template<typename Direction>
+void WellScheme<0, Direction>::evaluate_simulation_result(WellDoubletControl& wdc,
+		const WellDoubletControl::balancing_properties_t& balancing_properties)
+{
+	wdc.set_balancing_properties(balancing_properties);
+	wdc.Q_H_sys_old = wdc.get_result().Q_H_sys;
+
+	if (wdc.get_result().Q_H_sys <= 0.)
+		wdc.heatPump.calculate_heat_source(wdc.get_result().Q_H_sys,
+			balancing_properties.T_UA, balancing_properties.T_HE);  // !!! call to update COP
 
-	if ((beyond(get_result().T_HE, value_threshold) || get_result().storage_state == powerrate_to_adapt) && get_result().storage_state != target_not_achievable )
+	if ((Direction::beyond(wdc.get_result().T_HE, wdc.value_threshold, 0.) ||
+			wdc.get_result().storage_state == WellDoubletControl::powerrate_to_adapt) &&
+			wdc.get_result().storage_state != WellDoubletControl::target_not_achievable )
 	{
-		set_storage_state(powerrate_to_adapt);
-		//set_powerrate(Q_H);
-		adapt_powerrate();
+		wdc.set_storage_state(WellDoubletControl::powerrate_to_adapt);
+		adapt_powerrate(wdc);
 	}
 }
 
-
-void WellScheme_0::estimate_flowrate()
+template<typename Direction>
+void WellScheme<0, Direction>::estimate_flowrate(WellDoubletControl& wdc)
 {
-	double flowrate = value_target;
+	double flowrate = wdc.value_target;
 
-	const double operability = (operationType == WellDoubletControl::storing) ?
-		wdc::make_threshold_factor(get_result().T_UA, value_threshold,
-			well_shutdown_temperature_range, wdc::upper) :
-		wdc::make_threshold_factor(get_result().T_UA, value_threshold,
-			well_shutdown_temperature_range, wdc::lower);
+	const double operability = wdc::make_threshold_factor(wdc.get_result().T_UA, wdc.value_threshold,
+			wdc.well_shutdown_temperature_range, Direction::shutdown_threshold());
 
 	if (operability < 1)
 	{
-		WDC_LOG("\t\toperability: " << operability);
+		WDC_EVENT(operability, operability);
 		flowrate *= operability;
-		set_powerrate(get_result().Q_H * operability);
-		set_storage_state(rates_reduced);
+		wdc.set_powerrate(wdc.get_result().Q_H * operability);
+		wdc.set_storage_state(WellDoubletControl::rates_reduced);
 	}
 
-	set_flowrate((operationType == WellDoubletControl::storing) ?
-		wdc::make_confined(flowrate, accuracies.flowrate, value_target) :
-		wdc::make_confined(flowrate, value_target, -accuracies.flowrate));
+	wdc.set_flowrate(Direction::confine_flowrate(flowrate, wdc.value_target, wdc.accuracies.flowrate));
 }
 
+template<typename Direction>
+void WellScheme<0, Direction>::warm_start_rates(WellDoubletControl& wdc, const WellDoubletControl::result_t& previous)
+{	// flowrate is given - continue adapting powerrate
+	if (previous.storage_state == WellDoubletControl::powerrate_to_adapt)
+	{
+		wdc.set_powerrate(wdc.limit_to_demand(previous.Q_H));
+		wdc.set_storage_state(WellDoubletControl::powerrate_to_adapt);
+	}
+}
 
-void WellScheme_0::adapt_powerrate()
+template<typename Direction>
+void WellScheme<0, Direction>::adapt_powerrate(WellDoubletControl& wdc)
 {
-	const double operability = (operationType == WellDoubletControl::storing) ?  // [0, 1]
-		wdc::make_threshold_factor(get_result().T_UA, value_threshold,  // storing
-			well_shutdown_temperature_range, wdc::upper) :
-		wdc::make_threshold_factor(get_result().T_UA, value_threshold,  // retrieving
-			well_shutdown_temperature_range, wdc::lower);
-
-	set_powerrate(operability * (get_result().Q_H  - c_powerrate_adaption_factor * fabs(get_result().Q_W) * volumetricHeatCapacity_HE * (
-		get_result().T_HE - value_threshold)));
-/*
-	std::cout << "Diff:   " <<  c_powerrate_adaption_factor * fabs(get_result().Q_W) * volumetricHeatCapacity_HE * (
-		get_result().T_HE - value_threshold) << '\n';
-
-	std::cout << "Thresh: " << value_threshold << '\n';
-*/
+	wdc.count_powerrate_adaption();
+	const double operability = wdc::make_threshold_factor(wdc.get_result().T_UA, wdc.value_threshold,  // [0, 1]
+			wdc.well_shutdown_temperature_range, Direction::shutdown_threshold());
+
+	const double powerrate = wdc.newton_powerrate(wdc.get_result().T_HE - wdc.value_threshold,
+		wdc.get_result().Q_H  - c_powerrate_adaption_factor * fabs(wdc.get_result().Q_W) *
+		wdc.volumetricHeatCapacity_HE * (wdc.get_result().T_HE - wdc.value_threshold));
+
+	wdc.set_powerrate(wdc.limit_to_demand(operability * powerrate));
+
 	if(operability < 1.)
 	{
-		WDC_LOG("\t\toperability: " << operability);
-		set_flowrate(operability * get_result().Q_W);
-		set_storage_state(rates_reduced);
+		WDC_EVENT(operability, operability);
+		wdc.set_flowrate(operability * wdc.get_result().Q_W);
+		wdc.set_storage_state(WellDoubletControl::rates_reduced);
 	}
 
-	if (operationType == storing && 
-			get_result().Q_H < accuracies.powerrate && 
-			get_result().storage_state != rates_reduced)
-	{
-		set_powerrate(0.);
-		set_flowrate(accuracies.flowrate);
-		set_storage_state(target_not_achievable);
-	}
-	else if (operationType == extracting && 
-			get_result().Q_H > -accuracies.powerrate && 
-			get_result().storage_state != rates_reduced)
+	// storing: Q_H < accuracy, extracting: Q_H > -accuracy
+	if (Direction::sign() * wdc.get_result().Q_H < wdc.accuracies.powerrate &&
+			wdc.get_result().storage_state != WellDoubletControl::rates_reduced)
 	{
-		set_powerrate(0.);
-		set_flowrate(-accuracies.flowrate);
-		set_storage_state(target_not_achievable);
+		wdc.set_powerrate(0.);
+		wdc.set_flowrate(Direction::sign() * wdc.accuracies.flowrate);
+		wdc.set_storage_state(WellDoubletControl::target_not_achievable);
 	}
 }
 
 
-void WellScheme_1::configure_scheme()
+template<typename Direction>
+void WellScheme<1, Direction>::configure_scheme(WellDoubletControl& wdc)
 {
-	deltaTsign_stored = 0, flowrate_adaption_factor = c_flowrate_adaption_factor;
+	wdc.deltaTsign_stored = 0, wdc.flowrate_adaption_factor = c_flowrate_adaption_factor;
+	wdc.iterate_previous.set = wdc.iterate_below.set = wdc.iterate_above.set = false;
 
-	WDC_LOG("\t\t\tconfigure scheme 1");
-
-	if (operationType == storing)
-	{
-		WDC_LOG("\t\t\t\tfor storing");
-		beyond.configure(new wdc::Greater(accuracies.temperature));
-		notReached.configure(new wdc::Smaller(accuracies.temperature));
-	}
-	else
-	{
-		WDC_LOG("\t\t\t\tfor extracting");
-		beyond.configure(new wdc::Smaller(accuracies.temperature));
-		notReached.configure(new wdc::Greater(accuracies.temperature));
-	}
+	WDC_EVENT_TEXT(configure_scheme, Direction::name(), 1.);
 }
 
-void WellScheme_1::evaluate_simulation_result(const balancing_properties_t& balancing_properties)
+template<typename Direction>
+void WellScheme<1, Direction>::evaluate_simulation_result(WellDoubletControl& wdc,
+		const WellDoubletControl::balancing_properties_t& balancing_properties)
 {
-	set_balancing_properties(balancing_properties);
-	Q_H_sys_old = get_result().Q_H_sys;
-	Q_W_old = get_result().Q_W;
+	wdc.set_balancing_properties(balancing_properties);
+	wdc.Q_H_sys_old = wdc.get_result().Q_H_sys;
+	wdc.Q_W_old = wdc.get_result().Q_W;
 
-	const double Q_H = (get_result().Q_H_sys > 0.)? get_result().Q_H_sys : 
-		heatPump->calculate_heat_source(get_result().Q_H_sys, balancing_properties.T_UA, balancing_properties.T_HE);  // !!! call to update COP
+	if (wdc.get_result().Q_H_sys <= 0.)
+		wdc.heatPump.calculate_heat_source(wdc.get_result().Q_H_sys,
+			balancing_properties.T_UA, balancing_properties.T_HE);  // !!! call to update COP
 
-	// double simulation_result_aiming_at_target = 
-	//	(this->*(this->simulation_result_aiming_at_target))();
 	// first adapt flow rate if temperature 1 at warm well is not
 	// at target value
-	// std::cout << "here " << get_result().storage_state << " \n";
-	if (get_result().storage_state == on_demand)
+	if (wdc.get_result().storage_state == WellDoubletControl::on_demand)
 	{	// do not put this after adapt_powerrate below since
 		// powerrate must be adapted in this iteration if flow rate adaption fails
 		// otherwise error calucaltion in iteration loop results in zero
-		if (beyond(get_result().T_HE, value_target))
+		if (Direction::beyond(wdc.get_result().T_HE, wdc.value_target, wdc.accuracies.temperature))
 		{
-			if (fabs(get_result().Q_W - value_threshold) > accuracies.flowrate)
-				adapt_flowrate();
+			if (fabs(wdc.get_result().Q_W - wdc.value_threshold) > wdc.accuracies.flowrate)
+				adapt_flowrate(wdc);
 			else
 			{  // cannot store / extract the heat
-				WDC_LOG("\t\t\tstop adapting flow rate");
-				set_storage_state(powerrate_to_adapt);
-				//set_powerrate(get_result().Q_H);  // to set flag
+				WDC_EVENT(stop_adapting_flowrate);
+				wdc.set_storage_state(WellDoubletControl::powerrate_to_adapt);
 							// start adapting powerrate
 			}
 		}
-		else if (notReached(get_result().T_HE, value_target))
+		else if (Direction::notReached(wdc.get_result().T_HE, wdc.value_target, wdc.accuracies.temperature))
 		{
-			if (fabs(get_result().Q_W) > accuracies.flowrate)
-				adapt_flowrate();
-			else if(get_result().storage_state != rates_reduced)
+			if (fabs(wdc.get_result().Q_W) > wdc.accuracies.flowrate)
+				adapt_flowrate(wdc);
+			else if(wdc.get_result().storage_state != WellDoubletControl::rates_reduced)
 			{
-				set_storage_state(target_not_achievable);
+				wdc.set_storage_state(WellDoubletControl::target_not_achievable);
 				// cannot adapt flowrate further (and powerrate is too low)
 			}
 		}
 	}
 
-	if (get_result().storage_state == powerrate_to_adapt || get_result().storage_state == rates_reduced)
-		adapt_powerrate(); // start and continue adapting
+	if (wdc.get_result().storage_state == WellDoubletControl::powerrate_to_adapt ||
+			wdc.get_result().storage_state == WellDoubletControl::rates_reduced)
+		adapt_powerrate(wdc); // start and continue adapting
 				// iteration is checked by simulator
 }
 
-void WellScheme_1::estimate_flowrate()
+template<typename Direction>
+bool WellScheme<1, Direction>::flowrate_converged(const WellDoubletControl& wdc)
 {
-	const double denominator = (operationType == WellDoubletControl::storing) ?
-		volumetricHeatCapacity_HE * value_target - volumetricHeatCapacity_UA * get_result().T_UA : 
-		volumetricHeatCapacity_UA * get_result().T_UA - volumetricHeatCapacity_HE * value_target;
+	if(Direction::notReached(wdc.get_result().T_HE, wdc.value_target, wdc.accuracies.temperature) &&
+			wdc.get_result().storage_state == WellDoubletControl::on_demand)
+		return false;
+	return fabs(wdc.get_result().Q_W - wdc.Q_W_old) < wdc.accuracies.flowrate;
+}
 
-	double flowrate;
-     	if (operationType == WellDoubletControl::storing)
-		flowrate = (fabs(denominator) < DBL_MIN) ? accuracies.flowrate : get_result().Q_H / denominator;
-	else
-		flowrate = (fabs(denominator) < DBL_MIN) ? -accuracies.flowrate : get_result().Q_H / denominator;
+template<typename Direction>
+void WellScheme<1, Direction>::estimate_flowrate(WellDoubletControl& wdc)
+{
+	// storing: c_HE T_target - c_UA T_UA, extracting: c_UA T_UA - c_HE T_target
+	const double denominator = Direction::sign() * (wdc.volumetricHeatCapacity_HE * wdc.value_target -
+			wdc.volumetricHeatCapacity_UA * wdc.get_result().T_UA);
+
+	double flowrate = (fabs(denominator) < DBL_MIN) ?
+		Direction::sign() * wdc.accuracies.flowrate : wdc.get_result().Q_H / denominator;
 
-	const double operability = (operationType == WellDoubletControl::storing) ?
-		wdc::make_threshold_factor(get_result().T_UA, value_target,
-			well_shutdown_temperature_range, wdc::upper) :
-		wdc::make_threshold_factor(get_result().T_UA, value_target,
-			well_shutdown_temperature_range, wdc::lower);
+	const double operability = wdc::make_threshold_factor(wdc.get_result().T_UA, wdc.value_target,
+			wdc.well_shutdown_temperature_range, Direction::shutdown_threshold());
 
 	if (operability < 1.)
 	{
-		WDC_LOG("\t\toperability: " << operability);
+		WDC_EVENT(operability, operability);
 		flowrate *= operability;
-		set_powerrate(get_result().Q_H * operability);
-		set_storage_state(rates_reduced);
+		wdc.set_powerrate(wdc.get_result().Q_H * operability);
+		wdc.set_storage_state(WellDoubletControl::rates_reduced);
 	}
 
+	wdc.set_flowrate(Direction::confine_flowrate(flowrate, wdc.value_threshold, wdc.accuracies.flowrate));
+}
 
-	set_flowrate((operationType == WellDoubletControl::storing) ?
-		wdc::make_confined(flowrate, accuracies.flowrate, value_threshold) :
-		wdc::make_confined(flowrate, value_threshold, -accuracies.flowrate));
+template<typename Direction>
+void WellScheme<1, Direction>::warm_start_rates(WellDoubletControl& wdc, const WellDoubletControl::result_t& previous)
+{	// start from converged flowrate instead of analytic estimate
+	if (previous.storage_state == WellDoubletControl::on_demand)
+		wdc.set_flowrate(Direction::confine_flowrate(previous.Q_W, wdc.value_threshold, wdc.accuracies.flowrate));
+	else if (previous.storage_state == WellDoubletControl::powerrate_to_adapt)
+	{	// flowrate was at threshold - continue adapting powerrate
+		wdc.set_flowrate(Direction::confine_flowrate(previous.Q_W, wdc.value_threshold, wdc.accuracies.flowrate));
+		wdc.set_powerrate(wdc.limit_to_demand(previous.Q_H));
+		wdc.set_storage_state(WellDoubletControl::powerrate_to_adapt);
+	}
 }
 
-void WellScheme_1::adapt_flowrate()
+template<typename Direction>
+void WellScheme<1, Direction>::adapt_flowrate(WellDoubletControl& wdc)
 {
-	double deltaT = get_result().T_HE - value_target;
+	wdc.count_flowrate_adaption();
+	double deltaT = wdc.get_result().T_HE - wdc.value_target;
 
-	if (operationType == WellDoubletControl::storing)
-		deltaT /= std::max(get_result().T_HE - get_result().T_UA, 1.);
-	else
-		deltaT /= std::max(get_result().T_UA - get_result().T_HE, 1.);
+	// storing: T_HE - T_UA, extracting: T_UA - T_HE
+	deltaT /= std::max(Direction::sign() * (wdc.get_result().T_HE - wdc.get_result().T_UA), 1.);
 
 	// decreases flowrate_adaption_factor to avoid that T_HE jumps 
 	// around threshold (deltaT flips sign)
-	if (deltaTsign_stored != 0  // == 0: take initial value for factor
-		&& deltaTsign_stored != wdc::sign(deltaT))
-		flowrate_adaption_factor = (c_flowrate_adaption_factor == 1) ?
-		flowrate_adaption_factor * 0.9 :  // ?????
-		flowrate_adaption_factor * c_flowrate_adaption_factor;
-
-	deltaTsign_stored = wdc::sign(deltaT);
+	if (wdc.deltaTsign_stored != 0  // == 0: take initial value for factor
+		&& wdc.deltaTsign_stored != wdc::sign(deltaT))
+		wdc.flowrate_adaption_factor = (c_flowrate_adaption_factor == 1) ?
+		wdc.flowrate_adaption_factor * 0.9 :  // ?????
+		wdc.flowrate_adaption_factor * c_flowrate_adaption_factor;
 
+	wdc.deltaTsign_stored = wdc::sign(deltaT);
 
-	const double operability = (operationType == WellDoubletControl::storing) ?  // [0, 1]
-		wdc::make_threshold_factor(get_result().T_UA, value_target,  // storing
-			well_shutdown_temperature_range, wdc::upper) :
-		wdc::make_threshold_factor(get_result().T_UA, value_target,  // retrieving
-			well_shutdown_temperature_range, wdc::lower);
+	const double operability = wdc::make_threshold_factor(wdc.get_result().T_UA, wdc.value_target,  // [0, 1]
+			wdc.well_shutdown_temperature_range, Direction::shutdown_threshold());
 	// temperature at cold well 2 
 	// should not reach threshold of warm well 1
 
 	if (operability < 1.)
 	{	
-		WDC_LOG("\t\toperability: " << operability);
-		set_powerrate(get_result().Q_H * operability);
-		set_storage_state(rates_reduced);
+		WDC_EVENT(operability, operability);
+		wdc.set_powerrate(wdc.get_result().Q_H * operability);
+		wdc.set_storage_state(WellDoubletControl::rates_reduced);
+	}
+
+	// storing: Q_W (1 + a deltaT), extracting: Q_W (1 - a deltaT)
+	double flowrate = operability * wdc.get_result().Q_W *
+		(1 + Direction::sign() * wdc.flowrate_adaption_factor * deltaT);
+	if (wdc.flowrate_adaption == WellDoubletControl::secant)
+		adapt_flowrate_secant(wdc, operability, flowrate);
+
+	wdc.set_flowrate(Direction::confine_flowrate(flowrate, wdc.value_threshold, wdc.accuracies.flowrate));
+}
+
+template<typename Direction>
+void WellScheme<1, Direction>::adapt_flowrate_secant(WellDoubletControl& wdc,
+		const double& operability, double& flowrate)
+{	// flowrate is the fixed point step on input - replaced if iterates allow a secant step
+	const double Q_W = wdc.get_result().Q_W;
+	const double residual = wdc.get_result().T_HE - wdc.value_target;
+	const WellDoubletControl::iterate_t previous = wdc.iterate_previous;
+
+	wdc.iterate_previous = { Q_W, residual, true };
+	if (residual < 0.)
+		wdc.iterate_below = wdc.iterate_previous;
+	else
+		wdc.iterate_above = wdc.iterate_previous;
+
+	const WellDoubletControl::iterate_t& below = wdc.iterate_below;
+	const WellDoubletControl::iterate_t& above = wdc.iterate_above;
+	const bool bracketed = below.set && above.set && fabs(above.residual - below.residual) > DBL_MIN;
+
+	double secant_flowrate;
+	if (previous.set && fabs(residual - previous.residual) > DBL_MIN)
+		secant_flowrate = Q_W - residual * (Q_W - previous.Q_W) / (residual - previous.residual);
+	else if (bracketed)
+		secant_flowrate = Q_W;  // replaced by regula falsi below
+	else
+		return;  // keep fixed point step
+
+	if (bracketed)
+	{	// stay inside bracket
+		if (secant_flowrate <= std::min(below.Q_W, above.Q_W) || secant_flowrate >= std::max(below.Q_W, above.Q_W))
+			secant_flowrate = (below.Q_W * above.residual - above.Q_W * below.residual) /
+						(above.residual - below.residual);
 	}
+	else if ((secant_flowrate - Q_W) * Direction::sign() * residual * Q_W <= 0.)
+		return;  // not the direction of the fixed point step - secant slope not reliable yet
 
-	set_flowrate((operationType == WellDoubletControl::storing) ?
-		wdc::make_confined(operability * get_result().Q_W *
-		(1 + flowrate_adaption_factor * deltaT),
-			accuracies.flowrate, value_threshold) :
-		wdc::make_confined(operability * get_result().Q_W *
-		(1 - flowrate_adaption_factor * deltaT),
-			value_threshold, -accuracies.flowrate));
+	WDC_EVENT(secant_step);
+	flowrate = operability * secant_flowrate;
 }
 
-void WellScheme_1::adapt_powerrate()
+template<typename Direction>
+void WellScheme<1, Direction>::adapt_powerrate(WellDoubletControl& wdc)
 {
-	double powerrate = get_result().Q_H - c_powerrate_adaption_factor * fabs(get_result().Q_W) * volumetricHeatCapacity_HE * (
-		get_result().T_HE -
+	wdc.count_powerrate_adaption();
+	double powerrate = wdc.get_result().Q_H - c_powerrate_adaption_factor * fabs(wdc.get_result().Q_W) *
+		wdc.volumetricHeatCapacity_HE * (wdc.get_result().T_HE -
 		// Scheme A: T_HE, Scheme C: T_HE - T_UA
 // should take actually also volumetricHeatCapacity_UA 
-value_target);
+wdc.value_target);
+	powerrate = wdc.newton_powerrate(wdc.get_result().T_HE - wdc.value_target, powerrate);
 
-	const double operability = (operationType == WellDoubletControl::storing) ?  // [0, 1]
-		wdc::make_threshold_factor(get_result().T_UA, value_target,  // storing
-			well_shutdown_temperature_range, wdc::upper) :
-		wdc::make_threshold_factor(get_result().T_UA, value_target,  // retrieving
-			well_shutdown_temperature_range, wdc::lower);
+	const double operability = wdc::make_threshold_factor(wdc.get_result().T_UA, wdc.value_target,  // [0, 1]
+			wdc.well_shutdown_temperature_range, Direction::shutdown_threshold());
 	// temperature at cold well 2 
 	// should not reach threshold of warm well 1
 
 	if (operability < 1.)
 	{	
-		WDC_LOG("\t\toperability: " << operability);
+		WDC_EVENT(operability, operability);
 		powerrate *= operability;
 	}
 
-	set_powerrate(powerrate);
+	powerrate = wdc.limit_to_demand(powerrate);
+	wdc.set_powerrate(powerrate);
 	
-	if (operationType == storing && powerrate < accuracies.powerrate) 
-	{
-		set_powerrate(0.);
-		set_flowrate(accuracies.flowrate);
-		WDC_LOG("\t\t\tswitch off well");
-	}
-	else if	(operationType == extracting && powerrate > -accuracies.powerrate)
+	if (Direction::sign() * powerrate < wdc.accuracies.powerrate)
 	{
-		set_powerrate(0.);
-		set_flowrate(-accuracies.flowrate);
-		WDC_LOG("\t\t\tswitch off well");
+		wdc.set_powerrate(0.);
+		wdc.set_flowrate(Direction::sign() * wdc.accuracies.flowrate);
+		WDC_EVENT(switch_off_well);
 	}
 }
 
 
-void WellScheme_2::configure_scheme()
+template<typename Direction>
+void WellScheme<2, Direction>::configure_scheme(WellDoubletControl& wdc)
 {
-	deltaTsign_stored = 0, flowrate_adaption_factor = c_flowrate_adaption_factor;
+	wdc.deltaTsign_stored = 0, wdc.flowrate_adaption_factor = c_flowrate_adaption_factor;
 
-	WDC_LOG("\t\t\tconfigure scheme 1");
-
-	if (operationType == storing)
-	{
-		WDC_LOG("\t\t\t\tfor storing");
-		beyond.configure(new wdc::Greater(accuracies.temperature));
-		notReached.configure(new wdc::Smaller(accuracies.temperature));
-	}
-	else
-	{
-		WDC_LOG("\t\t\t\tfor extracting");
-		beyond.configure(new wdc::Smaller(accuracies.temperature));
-		notReached.configure(new wdc::Greater(accuracies.temperature));
-	}
+	WDC_EVENT_TEXT(configure_scheme, Direction::name(), 2.);
 }
 
-void WellScheme_2::evaluate_simulation_result(const balancing_properties_t& balancing_properties)
+template<typename Direction>
+void WellScheme<2, Direction>::evaluate_simulation_result(WellDoubletControl& wdc,
+		const WellDoubletControl::balancing_properties_t& balancing_properties)
 {
-	set_balancing_properties(balancing_properties);
-	Q_H_sys_old = get_result().Q_H_sys;
-	Q_W_old = get_result().Q_W;
+	wdc.set_balancing_properties(balancing_properties);
+	wdc.Q_H_sys_old = wdc.get_result().Q_H_sys;
+	wdc.Q_W_old = wdc.get_result().Q_W;
 
-	const double spread = get_result().T_HE - get_result().T_UA;
+	const double spread = wdc.get_result().T_HE - wdc.get_result().T_UA;
 
-	const double Q_H = (get_result().Q_H_sys > 0.) ? get_result().Q_H_sys : 
-		heatPump->calculate_heat_source(get_result().Q_H_sys, balancing_properties.T_UA, balancing_properties.T_HE);  // !!! call to update COP
+	if (wdc.get_result().Q_H_sys <= 0.)
+		wdc.heatPump.calculate_heat_source(wdc.get_result().Q_H_sys,
+			balancing_properties.T_UA, balancing_properties.T_HE);  // !!! call to update COP
 
-	if (get_result().storage_state == on_demand)
+	if (wdc.get_result().storage_state == WellDoubletControl::on_demand)
 	{	// do not put this after adapt_powerrate below since
 		// powerrate must be adapted in this iteration if flow rate adaption fails
 		// otherwise error calucaltion in iteration loop results in zero
-		if (beyond(spread, value_target))
+		if (Direction::beyond(spread, wdc.value_target, wdc.accuracies.temperature))
 		{
-			if (fabs(get_result().Q_W - value_threshold) > accuracies.flowrate)
-				adapt_flowrate();
+			if (fabs(wdc.get_result().Q_W - wdc.value_threshold) > wdc.accuracies.flowrate)
+				adapt_flowrate(wdc);
 			else
 			{  // cannot store / extract the heat
-				WDC_LOG("\t\t\tstop adapting flow rate");
-				set_storage_state(powerrate_to_adapt);
+				WDC_EVENT(stop_adapting_flowrate);
+				wdc.set_storage_state(WellDoubletControl::powerrate_to_adapt);
 							// start adapting powerrate
 			}
 		}
-		else if (notReached(spread, value_target))
+		else if (Direction::notReached(spread, wdc.value_target, wdc.accuracies.temperature))
 		{
-			if (fabs(get_result().Q_W) > accuracies.flowrate)
-				adapt_flowrate();
-			else if (get_result().storage_state != rates_reduced)
+			if (fabs(wdc.get_result().Q_W) > wdc.accuracies.flowrate)
+				adapt_flowrate(wdc);
+			else if (wdc.get_result().storage_state != WellDoubletControl::rates_reduced)
 			{
-				set_storage_state(target_not_achievable);
+				wdc.set_storage_state(WellDoubletControl::target_not_achievable);
 				// cannot adapt flowrate further (and powerrate is too low)
 			}
 		}
 	}
 
-	if (get_result().storage_state == powerrate_to_adapt)
-		adapt_powerrate(); // continue adapting
+	if (wdc.get_result().storage_state == WellDoubletControl::powerrate_to_adapt)
+		adapt_powerrate(wdc); // continue adapting
 				// iteration is checked by simulator
 }
 
-void WellScheme_2::estimate_flowrate()
+template<typename Direction>
+bool WellScheme<2, Direction>::flowrate_converged(const WellDoubletControl& wdc)
 {
-	const double denominator = (operationType == WellDoubletControl::storing) ?
-		volumetricHeatCapacity_HE * get_result().T_HE - volumetricHeatCapacity_UA * get_result().T_UA :
-		volumetricHeatCapacity_UA * get_result().T_UA - volumetricHeatCapacity_HE * get_result().T_HE;
+	if(Direction::beyond(wdc.get_result().T_HE - wdc.get_result().T_UA, wdc.value_target,
+			wdc.accuracies.temperature) && wdc.get_result().storage_state == WellDoubletControl::on_demand)
+		return false;
+	return fabs(wdc.get_result().Q_W - wdc.Q_W_old) < wdc.accuracies.flowrate;
+}
 
-	double flowrate;
-     	if (operationType == WellDoubletControl::storing)
-		flowrate = (fabs(denominator) < DBL_MIN) ? accuracies.flowrate : get_result().Q_H / denominator;
-	else
-		flowrate = (fabs(denominator) < DBL_MIN) ? -accuracies.flowrate : get_result().Q_H / denominator;
+template<typename Direction>
+void WellScheme<2, Direction>::estimate_flowrate(WellDoubletControl& wdc)
+{
+	// storing: c_HE T_HE - c_UA T_UA, extracting: c_UA T_UA - c_HE T_HE
+	const double denominator = Direction::sign() * (wdc.volumetricHeatCapacity_HE * wdc.get_result().T_HE -
+			wdc.volumetricHeatCapacity_UA * wdc.get_result().T_UA);
+
+	const double flowrate = (fabs(denominator) < DBL_MIN) ?
+		Direction::sign() * wdc.accuracies.flowrate : wdc.get_result().Q_H / denominator;
+
+	wdc.set_flowrate(Direction::confine_flowrate(flowrate, wdc.value_threshold, wdc.accuracies.flowrate));
+}
 
-	set_flowrate((operationType == WellDoubletControl::storing) ?
-		wdc::make_confined(flowrate, accuracies.flowrate, value_threshold) :
-		wdc::make_confined(flowrate, value_threshold, -accuracies.flowrate));
+template<typename Direction>
+void WellScheme<2, Direction>::warm_start_rates(WellDoubletControl& wdc, const WellDoubletControl::result_t& previous)
+{	// rates are confined as in scheme 1
+	WellScheme<1, Direction>::warm_start_rates(wdc, previous);
 }
 
-void WellScheme_2::adapt_flowrate()
+template<typename Direction>
+void WellScheme<2, Direction>::adapt_flowrate(WellDoubletControl& wdc)
 {
-	const double spread = get_result().T_HE  - get_result().T_UA;
+	wdc.count_flowrate_adaption();
+	const double spread = wdc.get_result().T_HE  - wdc.get_result().T_UA;
 
-	const double deltaQ_w = (operationType == WellDoubletControl::storing) ?
-		(spread - value_target) / value_target : 
-		(value_target - spread) / value_target;
+	// storing: (spread - target) / target, extracting: (target - spread) / target
+	const double deltaQ_w = Direction::sign() * (spread - wdc.value_target) / wdc.value_target;
 
-	set_flowrate((operationType == WellDoubletControl::storing) ?
-		wdc::make_confined(get_result().Q_W * (1 + deltaQ_w),
-			accuracies.flowrate, value_threshold) :
-		wdc::make_confined(get_result().Q_W * (1 - deltaQ_w), value_threshold, -accuracies.flowrate));
+	wdc.set_flowrate(Direction::confine_flowrate(wdc.get_result().Q_W * (1 + Direction::sign() * deltaQ_w),
+			wdc.value_threshold, wdc.accuracies.flowrate));
 }
 
-void WellScheme_2::adapt_powerrate()
+template<typename Direction>
+void WellScheme<2, Direction>::adapt_powerrate(WellDoubletControl& wdc)
 {
-	double spread = volumetricHeatCapacity_HE * get_result().T_HE - volumetricHeatCapacity_UA * get_result().T_UA;
+	wdc.count_powerrate_adaption();
+	double spread = wdc.volumetricHeatCapacity_HE * wdc.get_result().T_HE -
+			wdc.volumetricHeatCapacity_UA * wdc.get_result().T_UA;
 	if (fabs(spread) < DBL_MIN) 
-		spread =  (operationType == WellDoubletControl::storing) ? 1.e-10 : -1.e-10;
+		spread = Direction::sign() * 1.e-10;
 
-	const double powerrate = get_result().Q_H  -  fabs(get_result().Q_W) * c_powerrate_adaption_factor * 
-				(spread - value_target * volumetricHeatCapacity_HE);
+	const double residual = spread - wdc.value_target * wdc.volumetricHeatCapacity_HE;
+	const double powerrate = wdc.limit_to_demand(wdc.newton_powerrate(residual,
+			wdc.get_result().Q_H  -  fabs(wdc.get_result().Q_W) * c_powerrate_adaption_factor * residual));
 
-	set_powerrate(powerrate);
+	wdc.set_powerrate(powerrate);
 
-	if (operationType == storing && powerrate < accuracies.powerrate) 
+	if (Direction::sign() * powerrate < wdc.accuracies.powerrate)
 	{
-		set_powerrate(0.);
-		set_flowrate(accuracies.flowrate);
-		WDC_LOG("\t\t\tswitch off well");
-	}
-	else if	(operationType == extracting && powerrate > -accuracies.powerrate)
-	{
-		set_powerrate(0.);
-		set_flowrate(-accuracies.flowrate);
-		WDC_LOG("\t\t\tswitch off well");
+		wdc.set_powerrate(0.);
+		wdc.set_flowrate(Direction::sign() * wdc.accuracies.flowrate);
+		WDC_EVENT(switch_off_well);
 	}
 }
 
 
+template struct WellScheme<0, Storing>;
+template struct WellScheme<0, Extracting>;
+template struct WellScheme<1, Storing>;
+template struct WellScheme<1, Extracting>;
+template struct WellScheme<2, Storing>;
+template struct WellScheme<2, Extracting>;
+
+template class WellSchemeDispatch<0>;
+template class WellSchemeDispatch<1>;
+template class WellSchemeDispatch<2>;
 
 } // end namespace wdc
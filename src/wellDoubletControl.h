@@ -2,10 +2,14 @@
 #define WELL_DOUBLET_CONTROL_H
 
 #include <string>
+#include <algorithm>
+#include <cstdint>
 
 #include "wdc_config.h"
 #include "comparison.h"
 #include "heatPump.h"
+#include "statistics.h"
+#include "logger.h"
 
 namespace wdc
 {
@@ -25,10 +29,47 @@ const double c_flowrate_adaption_factor = .5;
 // Q_W = Q_W (1 +/- a (T_1 - value_target) / (T_HE - T_UA)) for scheme 1
 // it is multiplied with itself, if a threshold is hit
 // therefore: DO NOT USE 1 as value
+const double c_powerrate_newton_step_limit = 4.;
+// newton step for powerrate is at most this multiple of the fixed gain step
+
+
+// operation types as compile-time policies of the WellScheme family
+// comparisons and sign flips are resolved at compile time
+struct Storing
+{
+	static const char* name() { return "storing"; }
+	static double sign() { return 1.; }
+	static threshold_t shutdown_threshold() { return upper; }  // T_UA (cold well) rises to threshold
+	static bool beyond(const double& x, const double& y, const double& epsilon)
+	{ return Greater::compare(x, y, epsilon); }
+	static bool notReached(const double& x, const double& y, const double& epsilon)
+	{ return Smaller::compare(x, y, epsilon); }
+	static double confine_flowrate(const double& flowrate, const double& limit, const double& minimum)
+	{ return make_confined(flowrate, minimum, limit); }
+};
+
+struct Extracting
+{
+	static const char* name() { return "extracting"; }
+	static double sign() { return -1.; }
+	static threshold_t shutdown_threshold() { return lower; }  // T_UA falls to threshold
+	static bool beyond(const double& x, const double& y, const double& epsilon)
+	{ return Smaller::compare(x, y, epsilon); }
+	static bool notReached(const double& x, const double& y, const double& epsilon)
+	{ return Greater::compare(x, y, epsilon); }
+	static double confine_flowrate(const double& flowrate, const double& limit, const double& minimum)
+	{ return make_confined(flowrate, limit, -minimum); }
+};
+
+template<int SchemeID, typename Direction> struct WellScheme;
+struct checkpoint_t;  // checkpoint.h
+class TraceRecorder;  // trace.h
 
 
 class WellDoubletControl
 {
+	template<int, typename> friend struct WellScheme;
+
 public:
 	enum storage_state_t { powerrate_to_adapt, on_demand, target_not_achievable, rates_reduced };
 	struct result_t
@@ -45,6 +86,14 @@ public:
 	{
 		double T_HE, T_UA, volumetricHeatCapacity_HE, volumetricHeatCapacity_UA;
 	};
+	enum flowrate_adaption_t { fixed_point, secant };
+		// scheme 1 - fixed_point: Q_W (1 +/- a deltaT) with damped a
+		// secant: root of T_HE(Q_W) - T_target from last iterates (regula falsi if bracketed),
+		// falls back to fixed point step until two iterates exist or if step goes in wrong direction
+	enum powerrate_adaption_t { fixed_gain, newton };
+		// all schemes - fixed_gain: Q_H - a |Q_W| c_HE residual
+		// newton: Q_H - residual / s with s = d residual / d Q_H estimated from last iterates
+		// (1D Broyden update, starts with s of fixed gain step), falls back to fixed gain if s <= 0
 	struct accuracies_t
 	{
 		double temperature;  // 1.e-1  // for thresholds
@@ -55,29 +104,35 @@ private:
 	result_t result;  // for the client
 	int _scheme_ID;
 	double Q_H_sys_target;
+	std::shared_ptr<const wdc::COPTable> heatPumpTable;  // for TabulatedHeatPump - keeps the table alive
 protected:
-	wdc::HeatPump* heatPump;
+	wdc::HeatPumpVariant heatPump;  // stored inline (no allocation, no virtual call)
 	double well_shutdown_temperature_range;  // 10. - to shut down if storage is full or empty 
-	accuracies_t accuracies; // const
+	accuracies_t accuracies;  // temperature loosened by CouplingDriver with adaptive_tolerance while iterating
 
 	double Q_H_sys_old;  // for error evaluation
 	double Q_W_old;
 
 	WellDoubletControl(int __scheme_ID, double _well_shutdown_temperature_range, accuracies_t _accuracies) : 
-		_scheme_ID(__scheme_ID), heatPump(new wdc::NoHeatPump()), well_shutdown_temperature_range(_well_shutdown_temperature_range), 
-				accuracies(_accuracies), value_target(0.){} 
+		_scheme_ID(__scheme_ID), well_shutdown_temperature_range(_well_shutdown_temperature_range), 
+				accuracies(_accuracies), value_target(0.), flowrate_adaption(fixed_point),
+				powerrate_adaption(fixed_gain), statistics_enabled(false), traceRecorder(nullptr), trace_id(0),
+				warm_start(false)
+	{ reset(); }
+	WellDoubletControl(const WellDoubletControl&) = delete;
+	WellDoubletControl& operator=(const WellDoubletControl&) = delete;
 
 	void set_flowrate(const double& _Q_W)
 	{ 
 		result.Q_W = _Q_W; 
-		WDC_LOG("\t\t\tset flow rate\t" << _Q_W);
+		WDC_EVENT(set_flowrate, _Q_W);
 	}
 
 	void set_powerrate(const double& _Q_H) 
 	{ 
 		result.Q_H = _Q_H;
-		result.Q_H_sys = (_Q_H > 0.)? _Q_H : heatPump->get_heat_sink(_Q_H);
-		WDC_LOG("\t\t\tadapt power rate - Storage: " << _Q_H << " - System: " << result.Q_H_sys << " - COP: " << heatPump->get_COP());
+		result.Q_H_sys = (_Q_H > 0.)? _Q_H : heatPump.get_heat_sink(_Q_H);
+		WDC_EVENT(set_powerrate, _Q_H, result.Q_H_sys, heatPump.get_COP());
 		//result.storage_state = powerrate_to_adapt;
 	}
 
@@ -85,11 +140,11 @@ protected:
 	{
 		result.storage_state = _storage_state;
 		if(result.storage_state == powerrate_to_adapt)
-			WDC_LOG("\t\tpowerrate to adapt");
+			WDC_EVENT(powerrate_to_adapt);
 		if(result.storage_state == target_not_achievable)
-			WDC_LOG("\t\ttarget not achievable");
+			WDC_EVENT(target_not_achievable);
 		if(result.storage_state == rates_reduced)
-			WDC_LOG("\t\trates reduced");
+			WDC_EVENT(rates_reduced);
 	}
 
 	double volumetricHeatCapacity_HE, volumetricHeatCapacity_UA;  // parameter
@@ -100,21 +155,81 @@ protected:
 
 	enum {storing, extracting} operationType;
 
-	wdc::Comparison beyond, notReached;
+	double flowrate_adaption_factor, deltaTsign_stored;  // schemes 1, 2
+	// to store values from the last interation when adapting flowrate
+	flowrate_adaption_t flowrate_adaption;
+	struct iterate_t { double Q_W, residual; bool set; };  // residual: T_HE - value_target
+	iterate_t iterate_previous, iterate_below, iterate_above;
+			// secant: last iterate and closest ones with T_HE below / above target (bracket)
+
+	powerrate_adaption_t powerrate_adaption;
+	struct powerrate_iterate_t { double Q_H, residual; bool set; } powerrate_previous;
+	double powerrate_sensitivity;  // d residual / d Q_H (0: not estimated)
+	double newton_powerrate(const double& residual, const double& fixedGain_powerrate);
+			// returns fixedGain_powerrate if powerrate_adaption is fixed_gain
+
+	bool statistics_enabled;
+	mutable statistics_t statistics;  // converged() counts failed checks
+	void count_flowrate_adaption() { if(statistics_enabled) ++statistics.flowrate_adaptions; }
+	void count_powerrate_adaption() { if(statistics_enabled) ++statistics.powerrate_adaptions; }
+	void count_iteration(const storage_state_t& state_before);  // after evaluate_simulation_result
+
+	TraceRecorder* traceRecorder;  // records inputs and results if set
+	std::uint32_t trace_id;
+	void record_evaluate(const balancing_properties_t& balancing_properties) const;
+
+	bool warm_start;  // seed time step with converged rates of the previous one
+	bool previous_timeStep;  // result holds rates of a previous time step
+	double Q_H_demand;  // storage powerrate set in configure - limits adapted powerrate for warm start
+	double limit_to_demand(const double& powerrate) const
+	{
+		if(!warm_start) return powerrate;
+		return (Q_H_demand > 0.) ? std::min(powerrate, Q_H_demand) : std::max(powerrate, Q_H_demand);
+	}
 
 	void set_balancing_properties(const balancing_properties_t& balancing_properites);
 					// called in evaluate_simulation_result
 	virtual void estimate_flowrate() = 0;
+	virtual void warm_start_rates(const result_t& previous) = 0;  // after estimate_flowrate
 	void write_outputFile() const;
 public:
 	int get_scheme_ID() const { return _scheme_ID; }
 	double get_system_powerrate() const { return result.Q_H_sys; }
 	double get_system_target_powerrate() const { return Q_H_sys_target; }
-	double get_COP() const { return heatPump->get_COP(); }
-	double get_heatPumpParameter() const { return heatPump->get_parameter(); }
+	double get_COP() const { return heatPump.get_COP(); }
+	double get_heatPumpParameter() const { return heatPump.get_parameter(); }
 	void set_heatPump(const int& _type, const double& T_sink, const double& eta);
-
-	virtual ~WellDoubletControl() { delete heatPump; }
+			// 0: NoHeatPump, 1: CarnotHeatPump, 2: TabulatedHeatPump (table from set_heatPumpTable, eta unused)
+	void set_heatPumpTable(const std::shared_ptr<const wdc::COPTable>& table);
+			// a TabulatedHeatPump is set again with the new table (NoHeatPump if table is nullptr)
+	const std::shared_ptr<const wdc::COPTable>& get_heatPumpTable() const { return heatPumpTable; }
+
+	virtual ~WellDoubletControl() = default;
+
+	void set_warm_start(const bool& _warm_start) { warm_start = _warm_start; }
+	bool get_warm_start() const { return warm_start; }
+	void set_flowrate_adaption(const flowrate_adaption_t& _flowrate_adaption)
+	{ flowrate_adaption = _flowrate_adaption; }
+	flowrate_adaption_t get_flowrate_adaption() const { return flowrate_adaption; }
+	void set_powerrate_adaption(const powerrate_adaption_t& _powerrate_adaption)
+	{ powerrate_adaption = _powerrate_adaption; }
+	powerrate_adaption_t get_powerrate_adaption() const { return powerrate_adaption; }
+			// if on, configure starts from the flowrate and powerrate of the previous time step
+			// (same operation type) and keeps the flowrate adaption factor - do not reset in between
+
+	void set_statistics_enabled(const bool& _statistics_enabled) { statistics_enabled = _statistics_enabled; }
+	bool get_statistics_enabled() const { return statistics_enabled; }
+	const statistics_t& get_statistics() const { return statistics; }
+	void clear_statistics() { statistics.clear(); }  // not done by reset
+
+	void set_traceRecorder(TraceRecorder* recorder, const std::uint32_t& id = 0)
+	{ traceRecorder = recorder; trace_id = id; }
+			// null stops recording - id tells controllers apart in the trace (wdc_replay)
+	TraceRecorder* get_traceRecorder() const { return traceRecorder; }
+
+	void reset();  // back to state after construction (keeps heat pump and parameters)
+	void reset(const double& _well_shutdown_temperature_range, const accuracies_t& _accuracies);
+			// re-arm instance for another doublet - use instead of delete / create
 
 	result_t get_result() const { return result; }
 	virtual void configure_scheme() = 0;
@@ -133,73 +248,91 @@ public:
 	bool powerrate_converged() const { return fabs(result.Q_H_sys - Q_H_sys_old) < accuracies.powerrate; }
 	//virtual bool converged(double _T_HE, double accuracy) const = 0;
 	virtual bool flowrate_converged() const = 0;
-	bool converged() const { return flowrate_converged() && powerrate_converged(); }
+	bool converged() const
+	{
+		if(!statistics_enabled)
+			return flowrate_converged() && powerrate_converged();
+		const bool flowrate = flowrate_converged(), powerrate = powerrate_converged();
+		statistics.flowrate_not_converged += !flowrate;
+		statistics.powerrate_not_converged += !powerrate;
+		return flowrate && powerrate;
+	}
 	accuracies_t get_accuracies() const { return accuracies; } 
+	void set_accuracies(const accuracies_t& _accuracies) { accuracies = _accuracies; }
+			// within a time step (adaptive tolerances of CouplingDriver) - keeps state
+
+	void save_state(checkpoint_t& checkpoint) const;  // in checkpoint.cpp
+	bool restore_state(const checkpoint_t& checkpoint);  // false if scheme differs
 };
 
 
-class WellScheme_0 : public WellDoubletControl
+// scheme algorithms for one operation type (Storing, Extracting)
+// static functions work on the state of a WellDoubletControl instance
+// and are instantiated for schemes 0, 1, 2 in wellDoubletControl.cpp
+template<typename Direction>
+struct WellScheme<0, Direction>
 {
-        void estimate_flowrate() override;
-        void adapt_powerrate();
-
-public:
-	void configure_scheme() override;
-	WellScheme_0(const double& _well_shutdown_temperature_range, const accuracies_t& _accuracies) : 
-		WellDoubletControl(0, _well_shutdown_temperature_range, _accuracies) {}
-
-	void evaluate_simulation_result(const balancing_properties_t& balancing_properites) override;
-
-	//wdc_state get_state(double, double) const override { return wdc_state; }
+	static void configure_scheme(WellDoubletControl& wdc);
+	static void estimate_flowrate(WellDoubletControl& wdc);
+	static void warm_start_rates(WellDoubletControl& wdc, const WellDoubletControl::result_t& previous);
+	static void evaluate_simulation_result(WellDoubletControl& wdc,
+		const WellDoubletControl::balancing_properties_t& balancing_properties);
 		// convergence exclusively decided by simulator in scheme 0 - no iterations in wdc
-	bool flowrate_converged() const override { return true; }
+	static bool flowrate_converged(const WellDoubletControl& wdc) { return true; }
+private:
+	static void adapt_powerrate(WellDoubletControl& wdc);
 };
 
-class WellScheme_1 : public WellDoubletControl
+template<typename Direction>
+struct WellScheme<1, Direction>
 {
-	double flowrate_adaption_factor, deltaTsign_stored;
-	// to store values from the last interation when adapting flowrate
-        void estimate_flowrate() override;
-       	void adapt_flowrate();
-        void adapt_powerrate();
-public:
-	void configure_scheme() override;
-	WellScheme_1(const double& _well_shutdown_temperature_range, const accuracies_t& _accuracies) : 
-		WellDoubletControl(1, _well_shutdown_temperature_range, _accuracies) {}
+	static void configure_scheme(WellDoubletControl& wdc);
+	static void estimate_flowrate(WellDoubletControl& wdc);
+	static void warm_start_rates(WellDoubletControl& wdc, const WellDoubletControl::result_t& previous);
+	static void evaluate_simulation_result(WellDoubletControl& wdc,
+		const WellDoubletControl::balancing_properties_t& balancing_properties);
+	static bool flowrate_converged(const WellDoubletControl& wdc);
+private:
+	static void adapt_flowrate(WellDoubletControl& wdc);
+	static void adapt_flowrate_secant(WellDoubletControl& wdc, const double& operability, double& flowrate);
+	static void adapt_powerrate(WellDoubletControl& wdc);
+};
 
-	void evaluate_simulation_result(const balancing_properties_t& balancing_properites) override;
-	//bool converged(double _T_HE, double _accuracy) const override { return (fabs(_T_HE - value_target) < _accuracy || flag_converged); }
-	bool flowrate_converged() const override
-	{ 
-		if(notReached(get_result().T_HE, value_target) && get_result().storage_state == on_demand)
-			return false;
-		return fabs(get_result().Q_W - Q_W_old) < accuracies.flowrate;
-	}
+template<typename Direction>
+struct WellScheme<2, Direction>
+{
+	static void configure_scheme(WellDoubletControl& wdc);
+	static void estimate_flowrate(WellDoubletControl& wdc);
+	static void warm_start_rates(WellDoubletControl& wdc, const WellDoubletControl::result_t& previous);
+	static void evaluate_simulation_result(WellDoubletControl& wdc,
+		const WellDoubletControl::balancing_properties_t& balancing_properties);
+	static bool flowrate_converged(const WellDoubletControl& wdc);
+private:
+	static void adapt_flowrate(WellDoubletControl& wdc);
+	static void adapt_powerrate(WellDoubletControl& wdc);
 };
 
 
-class WellScheme_2 : public WellDoubletControl
+// runtime-to-template dispatch: picks WellScheme<SchemeID, Storing / Extracting>
+// from the operation type set in configure (instances created by the factory)
+template<int SchemeID>
+class WellSchemeDispatch final : public WellDoubletControl
 {
-	double flowrate_adaption_factor, deltaTsign_stored;
-	// to store values from the last interation when adapting flowrate
         void estimate_flowrate() override;
-       	void adapt_flowrate();
-        void adapt_powerrate();
+        void warm_start_rates(const result_t& previous) override;
 public:
 	void configure_scheme() override;
-	WellScheme_2(const double& _well_shutdown_temperature_range, const accuracies_t& _accuracies) : 
-		WellDoubletControl(2, _well_shutdown_temperature_range, _accuracies) {}
+	WellSchemeDispatch(const double& _well_shutdown_temperature_range, const accuracies_t& _accuracies) : 
+		WellDoubletControl(SchemeID, _well_shutdown_temperature_range, _accuracies) {}
 
 	void evaluate_simulation_result(const balancing_properties_t& balancing_properites) override;
-	//bool converged(double _T_HE, double _accuracy) const override { return (fabs(_T_HE - value_target) < _accuracy || flag_converged); }
-	bool flowrate_converged() const override 
-	{ 
-		if(beyond(get_result().T_HE - get_result().T_UA, value_target) && get_result().storage_state == on_demand)
-			return false;
-		return fabs(get_result().Q_W - Q_W_old) < accuracies.flowrate; 
-	}
+	bool flowrate_converged() const override;
 };
 
+typedef WellSchemeDispatch<0> WellScheme_0;
+typedef WellSchemeDispatch<1> WellScheme_1;
+typedef WellSchemeDispatch<2> WellScheme_2;
+
 
 } // end namespace wdc
 
@@ -0,0 +1,472 @@
+#include <cstdlib>
+#include <cfloat>  // for DBL_MIN
+#include <algorithm>
+#include "wellDoubletControlBatch.h"
+
+namespace wdc
+{
+
+WellDoubletControlBatch::WellDoubletControlBatch(const int& scheme_ID, const std::size_t& size,
+		const double& _well_shutdown_temperature_range, const accuracies_t& _accuracies) :
+	_scheme_ID(scheme_ID), _size(size),
+	well_shutdown_temperature_range(_well_shutdown_temperature_range), accuracies(_accuracies),
+	Q_H(size, 0.), Q_W(size, 0.), Q_H_sys(size, 0.), T_HE(size, 0.), T_UA(size, 0.),
+	storage_state(size, WellDoubletControl::on_demand),
+	volumetricHeatCapacity_HE(size, 0.), volumetricHeatCapacity_UA(size, 0.),
+	Q_H_sys_target(size, 0.), value_target(size, 0.), value_threshold(size, 0.),
+	storing(size, 1), sigma(size, -1.), flowrate_lower(size, 0.), flowrate_upper(size, 0.),
+	operability(size, 1.), isa(simd::scalar),
+	Q_H_sys_old(size, 0.), Q_W_old(size, 0.),
+	flowrate_adaption_factor(size, c_flowrate_adaption_factor), deltaTsign_stored(size, 0.),
+	heatPump_type(size, 0), heatPump_T_sink(size, 0.), heatPump_eta(size, 0.), COP(size, -1.),
+	heatPump_heat_sink(size, 0.)
+{
+	if(scheme_ID < 0 || scheme_ID > 2)
+	{
+		WDC_LOG("WDC batch failed");
+		abort();
+	}
+}
+
+void WellDoubletControlBatch::set_heatPump(const std::size_t& i, const int& _type, const double& T_sink, const double& eta)
+{
+	if(_type == 1)
+	{
+		heatPump_type[i] = 1;
+		heatPump_T_sink[i] = T_sink;
+		heatPump_eta[i] = eta;
+		COP[i] = -1.;
+	}
+	else if(_type == 2 && heatPumpTable)
+	{
+		heatPump_type[i] = 2;
+		heatPump_T_sink[i] = T_sink;
+		COP[i] = -1.;
+	}
+	else
+	{	// as WellDoubletControl::set_heatPump
+		heatPump_type[i] = 0;
+		COP[i] = -1.;
+	}
+	heatPump_heat_sink[i] = 0.;
+}
+
+double WellDoubletControlBatch::calculate_heat_source(const std::size_t& i,
+		const double& heat_sink, const double& T_source_in)
+{
+	if(heatPump_type[i] == 1)
+	{
+		COP[i] = carnot_COP(heatPump_T_sink[i], heatPump_eta[i], T_source_in);
+		if(COP[i] < 0.)
+		{
+			COP[i] = -1;
+			return heat_sink;
+		}
+		heatPump_heat_sink[i] = heat_sink;
+		return heat_sink * (COP[i]-1) / COP[i];
+	}
+	if(heatPump_type[i] == 2)
+	{	// as TabulatedHeatPump
+		COP[i] = heatPumpTable->interpolate(T_source_in, heatPump_T_sink[i]);
+		if(COP[i] <= 1.)
+		{
+			COP[i] = -1;
+			return heat_sink;
+		}
+		heatPump_heat_sink[i] = heat_sink;
+		return heat_sink * (COP[i]-1) / COP[i];
+	}
+	COP[i] = -1.;
+	heatPump_heat_sink[i] = heat_sink;
+	return heat_sink;
+}
+
+double WellDoubletControlBatch::get_heat_sink(const std::size_t& i, const double& heat_source) const
+{
+	return (heatPump_type[i] != 0) ? heat_source * COP[i] / (COP[i]-1) : heat_source;
+}
+
+void WellDoubletControlBatch::set_powerrate(const std::size_t& i, const double& _Q_H)
+{
+	Q_H[i] = _Q_H;
+	Q_H_sys[i] = (_Q_H > 0.)? _Q_H : get_heat_sink(i, _Q_H);
+}
+
+void WellDoubletControlBatch::set_balancing_properties(const std::size_t& i,
+		const balancing_properties_t& balancing_properties)
+{
+	T_HE[i] = balancing_properties.T_HE[i];
+	T_UA[i] = balancing_properties.T_UA[i];
+	volumetricHeatCapacity_HE[i] = balancing_properties.volumetricHeatCapacity_HE[i];
+	volumetricHeatCapacity_UA[i] = balancing_properties.volumetricHeatCapacity_UA[i];
+}
+
+void WellDoubletControlBatch::make_operabilities()
+{	// scheme 0: threshold, scheme 1: target, scheme 2: does not reduce rates
+	if(_scheme_ID == 2)
+		return;
+	simd::make_threshold_factor(T_UA.data(), (_scheme_ID == 0) ? value_threshold.data() : value_target.data(),
+		sigma.data(), well_shutdown_temperature_range, operability.data(), _size, isa);
+}
+
+void WellDoubletControlBatch::configure(const double* _Q_H_sys,
+		const double* _value_target, const double* _value_threshold,
+		const balancing_properties_t& balancing_properties)
+{
+	for(std::size_t i=0; i<_size; ++i)
+	{
+		set_balancing_properties(i, balancing_properties);
+
+		Q_H_sys_target[i] = _Q_H_sys[i];
+		Q_H_sys[i] = _Q_H_sys[i];
+		if(_Q_H_sys[i] > 0.)
+		{
+			storing[i] = 1;
+			sigma[i] = -1.;
+			Q_H[i] = _Q_H_sys[i];
+			Q_W[i] = accuracies.flowrate;
+		}
+		else
+		{
+			storing[i] = 0;
+			sigma[i] = 1.;
+			Q_H[i] = calculate_heat_source(i, _Q_H_sys[i], T_UA[i]);
+			Q_W[i] = -accuracies.flowrate;
+		}
+		storage_state[i] = WellDoubletControl::on_demand;
+
+		value_target[i] = _value_target[i];
+		value_threshold[i] = _value_threshold[i];
+
+		deltaTsign_stored[i] = 0, flowrate_adaption_factor[i] = c_flowrate_adaption_factor;
+
+		// scheme 0: value_target is flowrate, schemes 1, 2: value_threshold is flowrate
+		const double flowrate_limit = (_scheme_ID == 0) ? value_target[i] : value_threshold[i];
+		flowrate_lower[i] = storing[i] ? accuracies.flowrate : flowrate_limit;
+		flowrate_upper[i] = storing[i] ? flowrate_limit : -accuracies.flowrate;
+	}
+
+	make_operabilities();
+	switch(_scheme_ID)
+	{
+		case 0:
+			for(std::size_t i=0; i<_size; ++i)
+				estimate_flowrate_0(i);
+			break;
+		case 1:
+			for(std::size_t i=0; i<_size; ++i)
+				estimate_flowrate_1(i);
+			break;
+		case 2:
+			for(std::size_t i=0; i<_size; ++i)
+				estimate_flowrate_2(i);
+			break;
+	}
+	simd::make_confined(Q_W.data(), flowrate_lower.data(), flowrate_upper.data(), Q_W.data(), _size, isa);
+}
+
+void WellDoubletControlBatch::evaluate_simulation_result(const balancing_properties_t& balancing_properties)
+{
+	for(std::size_t i=0; i<_size; ++i)
+	{
+		set_balancing_properties(i, balancing_properties);
+		Q_H_sys_old[i] = Q_H_sys[i];
+		Q_W_old[i] = Q_W[i];
+		if(Q_H_sys[i] <= 0.)
+			calculate_heat_source(i, Q_H_sys[i], T_UA[i]);  // !!! call to update COP
+	}
+	make_operabilities();
+
+	switch(_scheme_ID)
+	{
+		case 0:
+			for(std::size_t i=0; i<_size; ++i)
+				evaluate_0(i);
+			break;
+		case 1:
+			for(std::size_t i=0; i<_size; ++i)
+				evaluate_1(i);
+			break;
+		case 2:
+			for(std::size_t i=0; i<_size; ++i)
+				evaluate_2(i);
+			break;
+	}
+}
+
+WellDoubletControlBatch::result_t WellDoubletControlBatch::get_result(const std::size_t& i) const
+{
+	result_t result;
+	result.Q_H = Q_H[i];
+	result.Q_W = Q_W[i];
+	result.Q_H_sys = Q_H_sys[i];
+	result.T_HE = T_HE[i];
+	result.T_UA = T_UA[i];
+	result.storage_state = storage_state[i];
+	return result;
+}
+
+bool WellDoubletControlBatch::flowrate_converged(const std::size_t& i) const
+{
+	switch(_scheme_ID)
+	{
+		case 1:
+			if(notReached(i, T_HE[i], value_target[i], accuracies.temperature) &&
+					storage_state[i] == WellDoubletControl::on_demand)
+				return false;
+			return fabs(Q_W[i] - Q_W_old[i]) < accuracies.flowrate;
+		case 2:
+			if(beyond(i, T_HE[i] - T_UA[i], value_target[i], accuracies.temperature) &&
+					storage_state[i] == WellDoubletControl::on_demand)
+				return false;
+			return fabs(Q_W[i] - Q_W_old[i]) < accuracies.flowrate;
+		default:
+			return true;
+	}
+}
+
+bool WellDoubletControlBatch::converged() const
+{
+	for(std::size_t i=0; i<_size; ++i)
+		if(!converged(i))
+			return false;
+	return true;
+}
+
+
+// scheme 0 - see WellScheme_0
+
+void WellDoubletControlBatch::estimate_flowrate_0(const std::size_t& i)
+{
+	double flowrate = value_target[i];
+
+	if (operability[i] < 1)
+	{
+		flowrate *= operability[i];
+		set_powerrate(i, Q_H[i] * operability[i]);
+		storage_state[i] = WellDoubletControl::rates_reduced;
+	}
+
+	Q_W[i] = flowrate;  // confined in configure
+}
+
+void WellDoubletControlBatch::evaluate_0(const std::size_t& i)
+{
+	if ((beyond(i, T_HE[i], value_threshold[i], 0.) || storage_state[i] == WellDoubletControl::powerrate_to_adapt) &&
+			storage_state[i] != WellDoubletControl::target_not_achievable)
+	{
+		storage_state[i] = WellDoubletControl::powerrate_to_adapt;
+		adapt_powerrate_0(i);
+	}
+}
+
+void WellDoubletControlBatch::adapt_powerrate_0(const std::size_t& i)
+{
+	set_powerrate(i, operability[i] * (Q_H[i] - c_powerrate_adaption_factor * fabs(Q_W[i]) * volumetricHeatCapacity_HE[i] * (
+		T_HE[i] - value_threshold[i])));
+
+	if(operability[i] < 1.)
+	{
+		Q_W[i] = operability[i] * Q_W[i];
+		storage_state[i] = WellDoubletControl::rates_reduced;
+	}
+
+	if (storing[i] && Q_H[i] < accuracies.powerrate &&
+			storage_state[i] != WellDoubletControl::rates_reduced)
+	{
+		set_powerrate(i, 0.);
+		Q_W[i] = accuracies.flowrate;
+		storage_state[i] = WellDoubletControl::target_not_achievable;
+	}
+	else if (!storing[i] && Q_H[i] > -accuracies.powerrate &&
+			storage_state[i] != WellDoubletControl::rates_reduced)
+	{
+		set_powerrate(i, 0.);
+		Q_W[i] = -accuracies.flowrate;
+		storage_state[i] = WellDoubletControl::target_not_achievable;
+	}
+}
+
+
+// scheme 1 - see WellScheme_1
+
+void WellDoubletControlBatch::estimate_flowrate_1(const std::size_t& i)
+{
+	const double denominator = storing[i] ?
+		volumetricHeatCapacity_HE[i] * value_target[i] - volumetricHeatCapacity_UA[i] * T_UA[i] :
+		volumetricHeatCapacity_UA[i] * T_UA[i] - volumetricHeatCapacity_HE[i] * value_target[i];
+
+	double flowrate;
+	if (storing[i])
+		flowrate = (fabs(denominator) < DBL_MIN) ? accuracies.flowrate : Q_H[i] / denominator;
+	else
+		flowrate = (fabs(denominator) < DBL_MIN) ? -accuracies.flowrate : Q_H[i] / denominator;
+
+	if (operability[i] < 1.)
+	{
+		flowrate *= operability[i];
+		set_powerrate(i, Q_H[i] * operability[i]);
+		storage_state[i] = WellDoubletControl::rates_reduced;
+	}
+
+	Q_W[i] = flowrate;  // confined in configure
+}
+
+void WellDoubletControlBatch::evaluate_1(const std::size_t& i)
+{
+	if (storage_state[i] == WellDoubletControl::on_demand)
+	{
+		if (beyond(i, T_HE[i], value_target[i], accuracies.temperature))
+		{
+			if (fabs(Q_W[i] - value_threshold[i]) > accuracies.flowrate)
+				adapt_flowrate_1(i);
+			else
+				storage_state[i] = WellDoubletControl::powerrate_to_adapt;
+		}
+		else if (notReached(i, T_HE[i], value_target[i], accuracies.temperature))
+		{
+			if (fabs(Q_W[i]) > accuracies.flowrate)
+				adapt_flowrate_1(i);
+			else if (storage_state[i] != WellDoubletControl::rates_reduced)
+				storage_state[i] = WellDoubletControl::target_not_achievable;
+		}
+	}
+
+	if (storage_state[i] == WellDoubletControl::powerrate_to_adapt ||
+			storage_state[i] == WellDoubletControl::rates_reduced)
+		adapt_powerrate_1(i);
+}
+
+void WellDoubletControlBatch::adapt_flowrate_1(const std::size_t& i)
+{
+	double deltaT = T_HE[i] - value_target[i];
+
+	if (storing[i])
+		deltaT /= std::max(T_HE[i] - T_UA[i], 1.);
+	else
+		deltaT /= std::max(T_UA[i] - T_HE[i], 1.);
+
+	if (deltaTsign_stored[i] != 0
+		&& deltaTsign_stored[i] != wdc::sign(deltaT))
+		flowrate_adaption_factor[i] = (c_flowrate_adaption_factor == 1) ?
+		flowrate_adaption_factor[i] * 0.9 :
+		flowrate_adaption_factor[i] * c_flowrate_adaption_factor;
+
+	deltaTsign_stored[i] = wdc::sign(deltaT);
+
+	if (operability[i] < 1.)
+	{
+		set_powerrate(i, Q_H[i] * operability[i]);
+		storage_state[i] = WellDoubletControl::rates_reduced;
+	}
+
+	Q_W[i] = storing[i] ?
+		wdc::make_confined(operability[i] * Q_W[i] *
+		(1 + flowrate_adaption_factor[i] * deltaT), flowrate_lower[i], flowrate_upper[i]) :
+		wdc::make_confined(operability[i] * Q_W[i] *
+		(1 - flowrate_adaption_factor[i] * deltaT), flowrate_lower[i], flowrate_upper[i]);
+}
+
+void WellDoubletControlBatch::adapt_powerrate_1(const std::size_t& i)
+{
+	double powerrate = Q_H[i] - c_powerrate_adaption_factor * fabs(Q_W[i]) * volumetricHeatCapacity_HE[i] * (
+		T_HE[i] - value_target[i]);
+
+	if (operability[i] < 1.)
+		powerrate *= operability[i];
+
+	set_powerrate(i, powerrate);
+
+	if (storing[i] && powerrate < accuracies.powerrate)
+	{
+		set_powerrate(i, 0.);
+		Q_W[i] = accuracies.flowrate;
+	}
+	else if (!storing[i] && powerrate > -accuracies.powerrate)
+	{
+		set_powerrate(i, 0.);
+		Q_W[i] = -accuracies.flowrate;
+	}
+}
+
+
+// scheme 2 - see WellScheme_2
+
+void WellDoubletControlBatch::estimate_flowrate_2(const std::size_t& i)
+{
+	const double denominator = storing[i] ?
+		volumetricHeatCapacity_HE[i] * T_HE[i] - volumetricHeatCapacity_UA[i] * T_UA[i] :
+		volumetricHeatCapacity_UA[i] * T_UA[i] - volumetricHeatCapacity_HE[i] * T_HE[i];
+
+	double flowrate;
+	if (storing[i])
+		flowrate = (fabs(denominator) < DBL_MIN) ? accuracies.flowrate : Q_H[i] / denominator;
+	else
+		flowrate = (fabs(denominator) < DBL_MIN) ? -accuracies.flowrate : Q_H[i] / denominator;
+
+	Q_W[i] = flowrate;  // confined in configure
+}
+
+void WellDoubletControlBatch::evaluate_2(const std::size_t& i)
+{
+	const double spread = T_HE[i] - T_UA[i];
+
+	if (storage_state[i] == WellDoubletControl::on_demand)
+	{
+		if (beyond(i, spread, value_target[i], accuracies.temperature))
+		{
+			if (fabs(Q_W[i] - value_threshold[i]) > accuracies.flowrate)
+				adapt_flowrate_2(i);
+			else
+				storage_state[i] = WellDoubletControl::powerrate_to_adapt;
+		}
+		else if (notReached(i, spread, value_target[i], accuracies.temperature))
+		{
+			if (fabs(Q_W[i]) > accuracies.flowrate)
+				adapt_flowrate_2(i);
+			else if (storage_state[i] != WellDoubletControl::rates_reduced)
+				storage_state[i] = WellDoubletControl::target_not_achievable;
+		}
+	}
+
+	if (storage_state[i] == WellDoubletControl::powerrate_to_adapt)
+		adapt_powerrate_2(i);
+}
+
+void WellDoubletControlBatch::adapt_flowrate_2(const std::size_t& i)
+{
+	const double spread = T_HE[i] - T_UA[i];
+
+	const double deltaQ_w = storing[i] ?
+		(spread - value_target[i]) / value_target[i] :
+		(value_target[i] - spread) / value_target[i];
+
+	Q_W[i] = storing[i] ?
+		wdc::make_confined(Q_W[i] * (1 + deltaQ_w), flowrate_lower[i], flowrate_upper[i]) :
+		wdc::make_confined(Q_W[i] * (1 - deltaQ_w), flowrate_lower[i], flowrate_upper[i]);
+}
+
+void WellDoubletControlBatch::adapt_powerrate_2(const std::size_t& i)
+{
+	double spread = volumetricHeatCapacity_HE[i] * T_HE[i] - volumetricHeatCapacity_UA[i] * T_UA[i];
+	if (fabs(spread) < DBL_MIN)
+		spread = storing[i] ? 1.e-10 : -1.e-10;
+
+	const double powerrate = Q_H[i] - fabs(Q_W[i]) * c_powerrate_adaption_factor *
+				(spread - value_target[i] * volumetricHeatCapacity_HE[i]);
+
+	set_powerrate(i, powerrate);
+
+	if (storing[i] && powerrate < accuracies.powerrate)
+	{
+		set_powerrate(i, 0.);
+		Q_W[i] = accuracies.flowrate;
+	}
+	else if (!storing[i] && powerrate > -accuracies.powerrate)
+	{
+		set_powerrate(i, 0.);
+		Q_W[i] = -accuracies.flowrate;
+	}
+}
+
+} // end namespace wdc
@@ -0,0 +1,120 @@
+#ifndef WELL_DOUBLET_CONTROL_BATCH_H
+#define WELL_DOUBLET_CONTROL_BATCH_H
+
+#include <vector>
+#include <cstddef>
+#include <memory>
+
+#include "wdc_config.h"
+#include "wellDoubletControl.h"
+#include "kernels.h"
+
+namespace wdc
+{
+
+struct checkpoint_t;  // checkpoint.h
+
+// controls many well doublets which are operated with the same scheme
+// state is kept in contiguous arrays (one entry per doublet) and
+// configure / evaluate_simulation_result run over all doublets in one call
+// per-doublet logic is the one of WellScheme_0/1/2 (results are identical)
+// operabilities and flowrate confinement are computed for all doublets at once with the
+// kernels in kernels.h - the default scalar kernels are exact, avx2 / avx512 (set_isa) use fast_pow
+class WellDoubletControlBatch
+{
+public:
+	typedef WellDoubletControl::storage_state_t storage_state_t;
+	typedef WellDoubletControl::result_t result_t;
+	typedef WellDoubletControl::accuracies_t accuracies_t;
+
+	struct balancing_properties_t  // arrays of length size()
+	{
+		const double *T_HE, *T_UA, *volumetricHeatCapacity_HE, *volumetricHeatCapacity_UA;
+	};
+private:
+	int _scheme_ID;
+	std::size_t _size;
+	double well_shutdown_temperature_range;
+	accuracies_t accuracies;
+
+	// result
+	std::vector<double> Q_H, Q_W, Q_H_sys, T_HE, T_UA;
+	std::vector<storage_state_t> storage_state;
+	// parameter and constraints
+	std::vector<double> volumetricHeatCapacity_HE, volumetricHeatCapacity_UA;
+	std::vector<double> Q_H_sys_target, value_target, value_threshold;
+	std::vector<char> storing;  // operation type: 1 storing, 0 extracting
+	std::vector<double> sigma;  // 1 extracting (lower threshold), -1 storing (upper threshold)
+	std::vector<double> flowrate_lower, flowrate_upper;  // confinement of flowrate
+	std::vector<double> operability;  // [0, 1] - updated with temperatures
+	simd::isa_t isa;
+	// iteration state
+	std::vector<double> Q_H_sys_old, Q_W_old;  // for error evaluation
+	std::vector<double> flowrate_adaption_factor, deltaTsign_stored;  // schemes 1, 2
+	// heat pump (0: NoHeatPump, 1: CarnotHeatPump, 2: TabulatedHeatPump)
+	std::vector<int> heatPump_type;
+	std::vector<double> heatPump_T_sink, heatPump_eta, COP;
+	std::vector<double> heatPump_heat_sink;  // of last operable calculate_heat_source (as HeatPump)
+	std::shared_ptr<const COPTable> heatPumpTable;  // shared by all doublets of type 2
+
+	double calculate_heat_source(const std::size_t& i, const double& heat_sink, const double& T_source_in);
+	double get_heat_sink(const std::size_t& i, const double& heat_source) const;
+
+	void set_powerrate(const std::size_t& i, const double& _Q_H);
+	void set_balancing_properties(const std::size_t& i, const balancing_properties_t& balancing_properties);
+	void make_operabilities();
+	bool beyond(const std::size_t& i, const double& x, const double& y, const double& epsilon) const
+	{ return storing[i] ? x > y + epsilon : x < y - epsilon; }
+	bool notReached(const std::size_t& i, const double& x, const double& y, const double& epsilon) const
+	{ return storing[i] ? x < y - epsilon : x > y + epsilon; }
+
+	void estimate_flowrate_0(const std::size_t& i);
+	void evaluate_0(const std::size_t& i);
+	void adapt_powerrate_0(const std::size_t& i);
+
+	void estimate_flowrate_1(const std::size_t& i);
+	void evaluate_1(const std::size_t& i);
+	void adapt_flowrate_1(const std::size_t& i);
+	void adapt_powerrate_1(const std::size_t& i);
+
+	void estimate_flowrate_2(const std::size_t& i);
+	void evaluate_2(const std::size_t& i);
+	void adapt_flowrate_2(const std::size_t& i);
+	void adapt_powerrate_2(const std::size_t& i);
+public:
+	WellDoubletControlBatch(const int& scheme_ID, const std::size_t& size,
+		const double& _well_shutdown_temperature_range, const accuracies_t& _accuracies);
+
+	int get_scheme_ID() const { return _scheme_ID; }
+	std::size_t size() const { return _size; }
+	accuracies_t get_accuracies() const { return accuracies; }
+
+	void set_isa(const simd::isa_t& _isa) { isa = _isa; }
+	simd::isa_t get_isa() const { return isa; }
+	void set_heatPump(const std::size_t& i, const int& _type, const double& T_sink, const double& eta);
+	void set_heatPumpTable(const std::shared_ptr<const COPTable>& table) { heatPumpTable = table; }
+	double get_COP(const std::size_t& i) const { return COP[i]; }
+
+	void configure(const double* _Q_H_sys, const double* _value_target, const double* _value_threshold,
+		const balancing_properties_t& balancing_properties);
+			// constraints are set at beginning of time step
+	void evaluate_simulation_result(const balancing_properties_t& balancing_properties);
+
+	result_t get_result(const std::size_t& i) const;
+	const double* get_powerrates() const { return Q_H.data(); }
+	const double* get_flowrates() const { return Q_W.data(); }
+	const double* get_system_powerrates() const { return Q_H_sys.data(); }
+	const storage_state_t* get_storage_states() const { return storage_state.data(); }
+
+	bool powerrate_converged(const std::size_t& i) const { return fabs(Q_H_sys[i] - Q_H_sys_old[i]) < accuracies.powerrate; }
+	bool flowrate_converged(const std::size_t& i) const;
+	bool converged(const std::size_t& i) const { return flowrate_converged(i) && powerrate_converged(i); }
+	bool converged() const;  // all doublets
+
+	void save_state(checkpoint_t* checkpoints) const;  // size() records - in checkpoint.cpp
+	bool restore_state(const checkpoint_t* checkpoints);  // false if a scheme differs
+};
+
+} // end namespace wdc
+
+#endif
@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "wellIndex.h"
+
+namespace wdc
+{
+
+void WellIndex::grid_t::build(const point_t* _coordinates, const std::size_t& n)
+{
+	double x1 = _coordinates[0].x, y1 = _coordinates[0].y;
+	x0 = x1, y0 = y1;
+	for(std::size_t i=1; i<n; ++i)
+	{
+		x0 = std::min(x0, _coordinates[i].x), x1 = std::max(x1, _coordinates[i].x);
+		y0 = std::min(y0, _coordinates[i].y), y1 = std::max(y1, _coordinates[i].y);
+	}
+	// about one point per cell - at most n + 1 cells per direction (points on a line)
+	const double width = x1 - x0, height = y1 - y0;
+	double cellSize = std::max(std::sqrt(width * height / n), std::max(width, height) / n);
+	if(!(cellSize > 0.))
+		cellSize = 1.;  // one point or all in one place
+	inverse_cellSize = 1. / cellSize;
+	nx = static_cast<std::size_t>(width * inverse_cellSize) + 1;
+	ny = static_cast<std::size_t>(height * inverse_cellSize) + 1;
+
+	// counting sort by cell
+	std::vector<std::size_t> cells(n);
+	cellStart.assign(nx * ny + 1, 0);
+	for(std::size_t i=0; i<n; ++i)
+	{
+		cells[i] = cell_y(_coordinates[i].y) * nx + cell_x(_coordinates[i].x);
+		++cellStart[cells[i] + 1];
+	}
+	for(std::size_t c=0; c<nx*ny; ++c)
+		cellStart[c+1] += cellStart[c];
+	std::vector<std::size_t> next(cellStart.begin(), cellStart.end() - 1);
+	points.resize(n);
+	coordinates.resize(n);
+	for(std::size_t i=0; i<n; ++i)  // ascending indices within a cell
+	{
+		const std::size_t k = next[cells[i]]++;
+		points[k] = i;
+		coordinates[k] = _coordinates[i];
+	}
+}
+
+std::size_t WellIndex::grid_t::cell_x(const double& x) const
+{
+	const double cell = (x - x0) * inverse_cellSize;
+	return (cell < 0.) ? 0 : std::min(static_cast<std::size_t>(cell), nx - 1);
+}
+
+std::size_t WellIndex::grid_t::cell_y(const double& y) const
+{
+	const double cell = (y - y0) * inverse_cellSize;
+	return (cell < 0.) ? 0 : std::min(static_cast<std::size_t>(cell), ny - 1);
+}
+
+std::size_t WellIndex::grid_t::find_nearest(const point_t& point) const
+{	// rings of cells around the cell of point - a point in ring k + 1 is at least k cells away
+	const std::size_t cx = cell_x(point.x), cy = cell_y(point.y);
+	double best_distance = std::numeric_limits<double>::max();
+	std::size_t best = 0;
+	auto scan = [&](const std::size_t& c)
+	{
+		for(std::size_t j=cellStart[c]; j<cellStart[c+1]; ++j)
+		{
+			const double dx = coordinates[j].x - point.x, dy = coordinates[j].y - point.y;
+			const double distance = dx * dx + dy * dy;
+			if(distance < best_distance || (distance == best_distance && points[j] < best))
+			{
+				best_distance = distance;
+				best = points[j];
+			}
+		}
+	};
+	for(std::size_t k=0; k<std::max(nx, ny); ++k)
+	{
+		const std::size_t x_begin = (cx >= k) ? cx - k : 0, x_end = std::min(cx + k, nx - 1);
+		const std::size_t y_begin = (cy >= k) ? cy - k : 0, y_end = std::min(cy + k, ny - 1);
+		for(std::size_t y=y_begin; y<=y_end; ++y)
+		{
+			if(y + k == cy || y == cy + k)
+				for(std::size_t x=x_begin; x<=x_end; ++x)
+					scan(y * nx + x);
+			else
+			{	// sides of the ring only
+				if(cx >= k)
+					scan(y * nx + cx - k);
+				if(k > 0 && cx + k < nx)
+					scan(y * nx + cx + k);
+			}
+		}
+		const double ring_distance = k / inverse_cellSize;
+		if(best_distance <= ring_distance * ring_distance)
+			break;
+	}
+	return best;
+}
+
+
+bool WellIndex::build(const point_t* meshNodes, const std::size_t& numberOfNodes,
+	const point_t* warmWells, const point_t* coldWells, const std::size_t& numberOfDoublets)
+{
+	wellNodes.clear();
+	if(numberOfNodes == 0)
+		return false;
+	wellCoordinates.resize(2 * numberOfDoublets);
+	for(std::size_t i=0; i<numberOfDoublets; ++i)
+	{
+		wellCoordinates[2*i] = warmWells[i];
+		wellCoordinates[2*i+1] = coldWells[i];
+	}
+
+	grid_t nodes;  // of the mesh - only to find the nodes of the wells
+	nodes.build(meshNodes, numberOfNodes);
+	wellNodes.resize(wellCoordinates.size());
+	for(std::size_t j=0; j<wellCoordinates.size(); ++j)
+		wellNodes[j] = nodes.find_nearest(wellCoordinates[j]);
+
+	if(numberOfDoublets > 0)
+		wells.build(wellCoordinates.data(), wellCoordinates.size());
+	else
+		wells = grid_t();
+	return true;
+}
+
+void WellIndex::find_neighbours(const std::size_t& i, const double& radius, std::vector<std::size_t>& neighbours) const
+{
+	neighbours.clear();
+	const double radius2 = radius * radius;
+	for(std::size_t w=2*i; w<2*i+2; ++w)
+	{
+		const point_t& point = wellCoordinates[w];
+		const std::size_t x_begin = wells.cell_x(point.x - radius), x_end = wells.cell_x(point.x + radius);
+		const std::size_t y_begin = wells.cell_y(point.y - radius), y_end = wells.cell_y(point.y + radius);
+		for(std::size_t y=y_begin; y<=y_end; ++y)
+			for(std::size_t c=y*wells.nx+x_begin; c<=y*wells.nx+x_end; ++c)
+				for(std::size_t j=wells.cellStart[c]; j<wells.cellStart[c+1]; ++j)
+				{
+					const double dx = wells.coordinates[j].x - point.x, dy = wells.coordinates[j].y - point.y;
+					if(wells.points[j] / 2 != i && dx * dx + dy * dy <= radius2)
+						neighbours.push_back(wells.points[j] / 2);
+				}
+	}
+	std::sort(neighbours.begin(), neighbours.end());
+	neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+}
+
+void WellIndex::gather(const double* temperatures, const double* Q_H, double* T_HE, double* T_UA) const
+{
+	const std::size_t n = get_numberOfDoublets();
+	for(std::size_t i=0; i<n; ++i)
+	{
+		const double T_warm = temperatures[wellNodes[2*i]], T_cold = temperatures[wellNodes[2*i+1]];
+		const bool storing = Q_H[i] > 0.;
+		T_HE[i] = storing ? T_warm : T_cold;
+		T_UA[i] = storing ? T_cold : T_warm;
+	}
+}
+
+void WellIndex::gather_wells(const double* temperatures, double* T_warm, double* T_cold) const
+{
+	const std::size_t n = get_numberOfDoublets();
+	for(std::size_t i=0; i<n; ++i)
+	{
+		T_warm[i] = temperatures[wellNodes[2*i]];
+		T_cold[i] = temperatures[wellNodes[2*i+1]];
+	}
+}
+
+}
@@ -0,0 +1,56 @@
+#ifndef WELL_INDEX_H
+#define WELL_INDEX_H
+
+#include <vector>
+#include <cstddef>
+
+namespace wdc
+{
+
+// static spatial index of the wells of many doublets on a mesh - built once per mesh
+// 	node of a well (nearest mesh node): precomputed, O(1)
+// 	doublets with a well within a radius of a well of a doublet: uniform grid over the wells, O(1) for radii
+// 		of the order of the well spacing
+// 	T_HE / T_UA of all doublets gathered into contiguous arrays (for WellDoubletControlBatch) in one pass
+// nodes and wells are hashed into uniform grids (cells are sorted - one array per grid, no buckets)
+class WellIndex
+{
+public:
+	struct point_t { double x, y; };
+private:
+	struct grid_t
+	{
+		double x0, y0, inverse_cellSize;
+		std::size_t nx, ny;
+		std::vector<std::size_t> cellStart;  // points of cell c: points[cellStart[c], cellStart[c+1])
+		std::vector<std::size_t> points;  // indices sorted by cell
+		std::vector<point_t> coordinates;  // sorted as points
+
+		void build(const point_t* _coordinates, const std::size_t& n);
+		std::size_t cell_x(const double& x) const;  // clamped to grid
+		std::size_t cell_y(const double& y) const;
+		std::size_t find_nearest(const point_t& point) const;
+	};
+
+	grid_t wells;  // 2 i: warm well, 2 i + 1: cold well of doublet i
+	std::vector<point_t> wellCoordinates;  // as wells
+	std::vector<std::size_t> wellNodes;
+public:
+	bool build(const point_t* meshNodes, const std::size_t& numberOfNodes,
+		const point_t* warmWells, const point_t* coldWells, const std::size_t& numberOfDoublets);
+			// false if there are no mesh nodes
+
+	std::size_t get_numberOfDoublets() const { return wellNodes.size() / 2; }
+	std::size_t get_warmNode(const std::size_t& i) const { return wellNodes[2*i]; }
+	std::size_t get_coldNode(const std::size_t& i) const { return wellNodes[2*i+1]; }
+
+	void find_neighbours(const std::size_t& i, const double& radius, std::vector<std::size_t>& neighbours) const;
+			// doublets (not i, ascending) with a well within radius of a well of doublet i
+	void gather(const double* temperatures, const double* Q_H, double* T_HE, double* T_UA) const;
+			// of nodal temperatures - T_HE at the injection well (warm if Q_H > 0), T_UA at the other
+	void gather_wells(const double* temperatures, double* T_warm, double* T_cold) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,59 @@
+/* couples the C interface (libwdc) with the one node heat exchanger model of the tests
+ * shows the calls of a host simulator per time step - and that wdc_capi.h is plain C */
+#include <stdio.h>
+#include "wdc_capi.h"
+
+#define N 4
+
+int main(void)
+{
+	const double Q_H[N] = { 1.e5, 1.e6, -1.e5, -5.e5 };
+	const double value_target[N] = { 100., 100., 25., 25. };
+	const double value_threshold[N] = { 0.01, 0.01, -0.01, -0.01 };
+	double T_HE[N], T_UA[N], T_HE_step[N], capacity[N];
+	double Q_H_result[N], Q_W[N];
+	int error, converged = 0, timeStep, iteration, i;
+	wdc_handle* handle;
+
+	if(wdc_api_version() != WDC_API_VERSION)
+	{
+		fprintf(stderr, "libwdc has API version %d, expected %d\n", wdc_api_version(), WDC_API_VERSION);
+		return 1;
+	}
+	handle = wdc_create(1, N, 10., 0.01, 10., 1.e-6, &error);
+	if(handle == NULL)
+	{
+		fprintf(stderr, "wdc_create failed (%d)\n", error);
+		return 1;
+	}
+	wdc_set_heatPump(handle, 3, 1, 70., 0.5);
+	for(i=0; i<N; ++i)
+	{
+		T_HE[i] = T_HE_step[i] = 50.;
+		T_UA[i] = (Q_H[i] > 0.) ? 10. : 50.;
+		capacity[i] = 5.e6;
+	}
+
+	for(timeStep=0; timeStep<5; ++timeStep)
+	{
+		wdc_configure_batch(handle, Q_H, value_target, value_threshold, T_HE, T_UA, capacity, capacity);
+		for(iteration=0; iteration<20 && !converged; ++iteration)
+		{
+			wdc_get_results(handle, Q_H_result, Q_W, NULL, NULL);
+			for(i=0; i<N; ++i)  /* simulator */
+				T_HE[i] = T_HE_step[i] + 1.e2 * ((Q_W[i] < 0. ? -Q_W[i] : Q_W[i]) * 0.5 * (T_UA[i] - T_HE_step[i]) +
+					Q_H_result[i] / capacity[i]);
+			wdc_evaluate_batch(handle, T_HE, T_UA, capacity, capacity, &converged);
+		}
+		wdc_get_results(handle, Q_H_result, Q_W, NULL, NULL);
+		printf("time step %d: %d iterations\n", timeStep, iteration);
+		for(i=0; i<N; ++i)
+		{
+			printf("\tQ_H: %g Q_W: %g T_HE: %g\n", Q_H_result[i], Q_W[i], T_HE[i]);
+			T_HE_step[i] = T_HE[i];
+		}
+		converged = 0;
+	}
+	wdc_destroy(handle);
+	return 0;
+}
@@ -0,0 +1,59 @@
+// replays a trace of coupling iterations (FakeSimulator::set_traceFile or
+// WellDoubletControl::set_traceRecorder) without simulator
+// usage: wdc_replay trace [--repeat n] [--no-check]
+// checks that the controllers reproduce the recorded results (exit code 1 if not)
+// and reports the throughput of the replay
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include "trace.h"
+#include "logger.h"
+
+int main(int argc, char* argv[])
+{
+	if(argc < 2)
+	{
+		std::cerr << "usage: " << argv[0] << " trace [--repeat n] [--no-check]\n";
+		return 1;
+	}
+	int repeat = 1;
+	bool check = true;
+	for(int i=2; i<argc; ++i)
+	{
+		if(!std::strcmp(argv[i], "--repeat") && i+1 < argc)
+			repeat = std::max(1, std::atoi(argv[++i]));
+		else if(!std::strcmp(argv[i], "--no-check"))
+			check = false;
+		else
+		{
+			std::cerr << "unknown option " << argv[i] << "\n";
+			return 1;
+		}
+	}
+
+	wdc::TraceReplay replay;
+	if(!replay.load(argv[1]))
+	{
+		std::cerr << "cannot read trace " << argv[1] << "\n";
+		return 1;
+	}
+	wdc::log::set_level(wdc::log::off);  // events would dominate
+
+	std::size_t numberOfMismatches = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for(int i=0; i<repeat; ++i)
+		numberOfMismatches += replay.run(check);
+	const double duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	const double numberOfEvents = static_cast<double>(replay.get_numberOfEvents()) * repeat;
+	std::cout << replay.get_numberOfControllers() << " controllers, " << replay.get_numberOfEvents() <<
+		" events (" << replay.get_numberOfEvaluations() << " evaluations) x " << repeat << "\n";
+	std::cout << duration << " s, " << 1.e9 * duration / numberOfEvents << " ns per event, " <<
+		numberOfEvents / duration << " events/s\n";
+	if(check)
+		std::cout << numberOfMismatches << " results differ from trace\n";
+	return (numberOfMismatches == 0) ? 0 : 1;
+}
@@ -0,0 +1,199 @@
+// runs independent FakeSimulator scenarios in parallel (work-stealing thread pool)
+// usage: wdc_sweep scenarios results [--threads n] [--repeat k] [--logs directory] [--traces directory]
+// 	[--gridSize n] [--implicit diffusivity] [--timeStepSize s] [--timeSteps n] [--copTable path] [--adaptive]
+// scenario file: one scenario per line, '#' starts a comment
+// 	scheme Q_H value_target value_threshold [heatPump_type T_sink eta]
+// results: one line per scenario (and repetition) in the order of the scenario file
+// each simulator writes to its own log file (--logs) and trace (--traces, for wdc_replay)
+// WDC_LOG output is discarded
+// --gridSize sets the nodes of the fake simulator grid (load generator)
+// --implicit diffusivity switches to the implicit solver, --timeStepSize and --timeSteps set the time stepping
+// --copTable loads the COP table for heatPump_type 2 (shared by all scenarios)
+// --adaptive loosens the controller accuracies while the coupling error is large (CouplingDriver)
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include "fakeSimulator.h"
+#include "threadPool.h"
+#include "logger.h"
+
+namespace
+{
+
+struct scenario_t
+{
+	int scheme;
+	double Q_H, value_target, value_threshold;
+	int heatPump_type;
+	double heatPump_T_sink, heatPump_eta;
+};
+
+struct result_t
+{
+	wdc::WellDoubletControl::result_t result;
+	int numberOfIterations;
+	double duration;  // microseconds
+};
+
+struct null_buffer_t : std::streambuf
+{
+	int overflow(int c) override { return c; }
+};
+
+bool read_scenarios(const char* path, std::vector<scenario_t>& scenarios)
+{
+	std::ifstream stream(path);
+	if(!stream)
+		return false;
+	std::string line;
+	int lineNumber = 0;
+	while(std::getline(stream, line))
+	{
+		++lineNumber;
+		line = line.substr(0, line.find('#'));
+		std::istringstream input(line);
+		scenario_t scenario = { 0, 0., 0., 0., 0, 0., 0. };
+		if(!(input >> scenario.scheme))
+			continue;  // empty line
+		if(!(input >> scenario.Q_H >> scenario.value_target >> scenario.value_threshold))
+		{
+			std::cerr << path << ":" << lineNumber << ": expected scheme Q_H value_target value_threshold\n";
+			return false;
+		}
+		input >> scenario.heatPump_type >> scenario.heatPump_T_sink >> scenario.heatPump_eta;
+		scenarios.push_back(scenario);
+	}
+	return true;
+}
+
+}  // end anonymous namespace
+
+
+int main(int argc, char* argv[])
+{
+	if(argc < 3)
+	{
+		std::cerr << "usage: " << argv[0] <<
+			" scenarios results [--threads n] [--repeat k] [--logs directory] [--traces directory]"
+			" [--gridSize n] [--implicit diffusivity] [--timeStepSize s] [--timeSteps n] [--copTable path]"
+			" [--adaptive]\n";
+		return 1;
+	}
+	std::size_t numberOfThreads = 0, repeat = 1, gridSize = c_gridSize;
+	std::string logs, traces;
+	bool implicit = false, adaptive = false;
+	double diffusivity = 0., timeStepSize = c_timeStepSize;
+	int numberOfTimeSteps = c_numberOfTimeSteps;
+	std::shared_ptr<const wdc::COPTable> copTable;
+	for(int i=3; i<argc; ++i)
+	{
+		if(!std::strcmp(argv[i], "--threads") && i+1 < argc)
+			numberOfThreads = std::atoi(argv[++i]);
+		else if(!std::strcmp(argv[i], "--repeat") && i+1 < argc)
+			repeat = std::max(1, std::atoi(argv[++i]));
+		else if(!std::strcmp(argv[i], "--logs") && i+1 < argc)
+			logs = argv[++i];
+		else if(!std::strcmp(argv[i], "--traces") && i+1 < argc)
+			traces = argv[++i];
+		else if(!std::strcmp(argv[i], "--gridSize") && i+1 < argc)
+			gridSize = std::strtoul(argv[++i], nullptr, 10);
+		else if(!std::strcmp(argv[i], "--implicit") && i+1 < argc)
+		{
+			implicit = true;
+			diffusivity = std::atof(argv[++i]);
+		}
+		else if(!std::strcmp(argv[i], "--timeStepSize") && i+1 < argc)
+			timeStepSize = std::atof(argv[++i]);
+		else if(!std::strcmp(argv[i], "--timeSteps") && i+1 < argc)
+			numberOfTimeSteps = std::atoi(argv[++i]);
+		else if(!std::strcmp(argv[i], "--copTable") && i+1 < argc)
+		{
+			copTable = wdc::COPTable::load(argv[++i]);
+			if(!copTable)
+			{
+				std::cerr << "cannot read COP table from " << argv[i] << "\n";
+				return 1;
+			}
+		}
+		else if(!std::strcmp(argv[i], "--adaptive"))
+			adaptive = true;
+		else
+		{
+			std::cerr << "unknown option " << argv[i] << "\n";
+			return 1;
+		}
+	}
+
+	std::vector<scenario_t> scenarios;
+	if(!read_scenarios(argv[1], scenarios))
+	{
+		std::cerr << "cannot read scenarios from " << argv[1] << "\n";
+		return 1;
+	}
+
+	// event log and std::cout are shared by all simulators - both are switched off
+	wdc::log::set_level(wdc::log::off);
+	null_buffer_t null_buffer;
+	std::streambuf* cout_buffer = std::cout.rdbuf(&null_buffer);
+
+	const std::size_t n = scenarios.size() * repeat;
+	std::vector<result_t> results(n);
+	const auto start = std::chrono::steady_clock::now();
+	std::size_t numberOfThreadsUsed;
+	long numberOfStolenTasks;
+	{
+		ThreadPool pool(numberOfThreads);
+		numberOfThreadsUsed = pool.size();
+		pool.parallel_for(n, [&](const std::size_t& i)
+		{
+			const scenario_t& scenario = scenarios[i % scenarios.size()];
+			FakeSimulator simulator;  // nothing shared between simulators
+			simulator.set_logFile(logs.empty() ? "" : logs + "/scenario_" + std::to_string(i) + ".txt");
+			if(!traces.empty())
+				simulator.set_traceFile(traces + "/scenario_" + std::to_string(i) + ".bin");
+			simulator.set_gridSize(gridSize);
+			if(implicit)
+			{
+				simulator.set_solver(FakeSimulator::implicit_upwind);
+				simulator.set_diffusivity(diffusivity);
+			}
+			simulator.set_timeStepSize(timeStepSize);
+			simulator.set_numberOfTimeSteps(numberOfTimeSteps);
+			simulator.set_adaptiveTolerance(adaptive);
+			simulator.set_heatPumpTable(copTable);
+			simulator.set_heatPump(scenario.heatPump_type, scenario.heatPump_T_sink, scenario.heatPump_eta);
+			simulator.simulate(scenario.scheme, scenario.Q_H, scenario.value_target, scenario.value_threshold);
+			results[i] = { simulator.get_wellDoubletControl()->get_result(),
+					simulator.get_numberOfIterations(), simulator.get_duration() };
+		});
+		numberOfStolenTasks = pool.get_numberOfStolenTasks();
+	}
+	const double duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::cout.rdbuf(cout_buffer);
+
+	std::ofstream stream(argv[2]);
+	stream << "# index scheme Q_H value_target value_threshold heatPump_type"
+		" Q_H Q_W T_HE T_UA storage_state iterations duration[us]\n";
+	for(std::size_t i=0; i<n; ++i)
+	{
+		const scenario_t& scenario = scenarios[i % scenarios.size()];
+		const result_t& result = results[i];
+		stream << i << " " << scenario.scheme << " " << scenario.Q_H << " " << scenario.value_target << " " <<
+			scenario.value_threshold << " " << scenario.heatPump_type << " " <<
+			result.result.Q_H << " " << result.result.Q_W << " " << result.result.T_HE << " " <<
+			result.result.T_UA << " " << result.result.storage_state << " " <<
+			result.numberOfIterations << " " << result.duration << "\n";
+	}
+
+	long numberOfIterations = 0;
+	for(const result_t& result : results)
+		numberOfIterations += result.numberOfIterations;
+	std::cerr << n << " simulations on " << numberOfThreadsUsed << " threads in " << duration << " s (" <<
+		numberOfStolenTasks << " stolen), " << numberOfIterations << " iterations\n";
+	return 0;
+}